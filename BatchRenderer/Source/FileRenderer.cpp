@@ -0,0 +1,125 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Runs audio files through one SEQAudioProcessor, the way a host would.
+
+  ==============================================================================
+*/
+
+#include "FileRenderer.h"
+
+FileRenderer::FileRenderer(const juce::MemoryBlock& state, int size, bool use_double_precision)
+    : block_size(juce::jmax(1, size)), double_precision(use_double_precision)
+{
+    format_manager.registerBasicFormats();
+
+    if (state.getSize() > 0)
+        processor.setStateInformation(state.getData(), (int)state.getSize());
+
+    processor.setNonRealtime(true);
+    processor.setProcessingPrecision(double_precision ? juce::AudioProcessor::doublePrecision : juce::AudioProcessor::singlePrecision);
+}
+
+std::unique_ptr<juce::AudioFormatReader> FileRenderer::create_reader(juce::AudioFormatManager& formats, const juce::File& file)
+{
+    // Mapped files are read straight from the page cache instead of being copied through a stream buffer
+    if (auto* format = formats.findFormatForFileExtension(file.getFileExtension()))
+    {
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped_reader(format->createMemoryMappedReader(file));
+        if (mapped_reader != nullptr && mapped_reader->mapEntireFile())
+            return mapped_reader;
+    }
+
+    return std::unique_ptr<juce::AudioFormatReader>(formats.createReaderFor(file));
+}
+
+RenderResult FileRenderer::render(const juce::File& input, const juce::File& output)
+{
+    RenderResult result;
+    auto start_ticks = juce::Time::getHighResolutionTicks();
+
+    auto reader = create_reader(format_manager, input);
+    if (reader == nullptr)
+    {
+        result.error = "Couldn't read " + input.getFullPathName();
+        return result;
+    }
+
+    auto num_channels = (int)reader->numChannels;
+    if (!prepare(reader->sampleRate, num_channels))
+    {
+        result.error = "Unsupported channel count: " + juce::String(num_channels);
+        return result;
+    }
+
+    // Same format, bit depth and metadata as the input
+    auto* format = format_manager.findFormatForFileExtension(output.getFileExtension());
+    output.getParentDirectory().createDirectory();
+    output.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream(output.createOutputStream());
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    if (format != nullptr && stream != nullptr)
+        writer.reset(format->createWriterFor(stream.get(), reader->sampleRate, (unsigned int)num_channels, (int)reader->bitsPerSample, reader->metadataValues, 0));
+
+    if (writer == nullptr)
+    {
+        result.error = "Couldn't write " + output.getFullPathName();
+        return result;
+    }
+    stream.release();
+
+    // Keep feeding (silence past the end) until the last input sample has made it through the latency
+    auto latency = (juce::int64)processor.getLatencySamples();
+    auto length = reader->lengthInSamples;
+    for (juce::int64 position = 0; position < length + latency; position += block_size)
+    {
+        auto num_samples = (int)juce::jmin((juce::int64)block_size, length + latency - position);
+        float_buffer.setSize(num_channels, num_samples, false, false, true);
+        reader->read(&float_buffer, 0, num_samples, position, true, true);
+        process_block();
+
+        auto num_delayed = (int)juce::jlimit((juce::int64)0, (juce::int64)num_samples, latency - position);
+        if (!writer->writeFromAudioSampleBuffer(float_buffer, num_delayed, num_samples - num_delayed))
+        {
+            result.error = "Couldn't write " + output.getFullPathName();
+            return result;
+        }
+    }
+    writer.reset();
+
+    result.succeeded = true;
+    result.audio_seconds = (double)length / reader->sampleRate;
+    result.render_seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start_ticks);
+    return result;
+}
+
+bool FileRenderer::prepare(double sample_rate, int num_channels)
+{
+    // Prepared from scratch for every file, so a file renders the same on any worker and in any order
+    processor.releaseResources();
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(num_channels));
+    layout.inputBuses.add(juce::AudioChannelSet::disabled());
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(num_channels));
+    if (!processor.setBusesLayout(layout))
+        return false;
+
+    processor.setRateAndBufferSizeDetails(sample_rate, block_size);
+    processor.prepareToPlay(sample_rate, block_size);
+    return true;
+}
+
+void FileRenderer::process_block()
+{
+    if (!double_precision)
+    {
+        processor.processBlock(float_buffer, midi_buffer);
+        return;
+    }
+
+    double_buffer.makeCopyOf(float_buffer, true);
+    processor.processBlock(double_buffer, midi_buffer);
+    float_buffer.makeCopyOf(double_buffer, true);
+}
@@ -0,0 +1,58 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Runs audio files through one SEQAudioProcessor, the way a host would.
+
+    Every file gets a fresh prepareToPlay at its own sample rate and channel
+    count and is then fed to processBlock in fixed size blocks, so the
+    output is exactly what the plugin produces in a host running that block
+    size. The plugin's latency is compensated: the output starts with the
+    first delayed sample and has the input's length.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+struct RenderResult
+{
+    bool succeeded{ false };
+    juce::String error;
+    double audio_seconds{ 0.0 };
+    double render_seconds{ 0.0 };
+
+    double get_realtime_factor() const noexcept { return render_seconds > 0.0 ? audio_seconds / render_seconds : 0.0; }
+};
+
+class FileRenderer
+{
+public:
+    // state is the blob from getStateInformation, empty for the default settings
+    FileRenderer(const juce::MemoryBlock& state, int block_size, bool double_precision);
+
+    RenderResult render(const juce::File& input, const juce::File& output);
+
+    // WAV and AIFF are read through a memory mapped reader, everything else through a stream
+    static std::unique_ptr<juce::AudioFormatReader> create_reader(juce::AudioFormatManager&, const juce::File&);
+
+private:
+    SEQAudioProcessor processor;
+    juce::AudioFormatManager format_manager;
+    const int block_size;
+    const bool double_precision;
+
+    bool prepare(double sample_rate, int num_channels);
+
+    // Runs float_buffer through processBlock in the chosen precision
+    void process_block();
+
+    juce::AudioBuffer<float> float_buffer;
+    juce::AudioBuffer<double> double_buffer;
+    juce::MidiBuffer midi_buffer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FileRenderer)
+};
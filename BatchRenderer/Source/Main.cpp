@@ -0,0 +1,137 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    SEQBatchRenderer: applies a saved SEQ state to a batch of audio files,
+    one SEQAudioProcessor per worker thread.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "FileRenderer.h"
+#include "WorkStealingPool.h"
+
+namespace
+{
+    const juce::String audio_file_pattern{ "*.wav;*.flac;*.aif;*.aiff" };
+
+    struct RenderJob
+    {
+        juce::File input, output;
+        juce::int64 size;
+    };
+
+    // Files are taken as they are, folders are searched recursively and keep their layout under output_folder
+    std::vector<RenderJob> collect_jobs(const juce::ArgumentList& arguments, const juce::File& output_folder)
+    {
+        std::vector<RenderJob> jobs;
+        for (auto& argument : arguments.arguments)
+        {
+            if (argument.isOption())
+                continue;
+
+            auto file = argument.resolveAsFile();
+            if (file.isDirectory())
+            {
+                for (auto& child : file.findChildFiles(juce::File::findFiles, true, audio_file_pattern))
+                    jobs.push_back({ child, output_folder.getChildFile(child.getRelativePathFrom(file)), child.getSize() });
+            }
+            else if (file.existsAsFile())
+            {
+                jobs.push_back({ file, output_folder.getChildFile(file.getFileName()), file.getSize() });
+            }
+            else
+            {
+                juce::ConsoleApplication::fail("No such file or folder: " + file.getFullPathName());
+            }
+        }
+
+        for (auto& job : jobs)
+            if (job.output == job.input)
+                juce::ConsoleApplication::fail("Would overwrite its own input: " + job.input.getFullPathName());
+
+        // Longest first, so no worker picks up a long file just as the others run out
+        std::stable_sort(jobs.begin(), jobs.end(), [](const RenderJob& lhs, const RenderJob& rhs) { return lhs.size > rhs.size; });
+        return jobs;
+    }
+
+    int get_int(const juce::ArgumentList& arguments, const juce::String& option, int default_value)
+    {
+        return arguments.containsOption(option) ? arguments.getValueForOption(option).getIntValue() : default_value;
+    }
+
+    void run_render(const juce::ArgumentList& arguments)
+    {
+        if (!arguments.containsOption("--output-dir"))
+            juce::ConsoleApplication::fail("Missing --output-dir");
+        auto output_folder = arguments.getFileForOption("--output-dir");
+
+        juce::MemoryBlock state;
+        if (arguments.containsOption("--state") && !arguments.getExistingFileForOption("--state").loadFileAsData(state))
+            juce::ConsoleApplication::fail("Couldn't read " + arguments.getValueForOption("--state"));
+
+        auto jobs = collect_jobs(arguments, output_folder);
+        if (jobs.empty())
+            juce::ConsoleApplication::fail("No audio files given");
+
+        auto block_size = get_int(arguments, "--block-size", 8192);
+        auto num_threads = get_int(arguments, "--threads", juce::SystemStats::getNumCpus());
+        auto double_precision = arguments.containsOption("--double");
+
+        // Each worker only ever touches its own processor
+        WorkStealingPool pool(juce::jmin(num_threads, (int)jobs.size()));
+        std::vector<std::unique_ptr<FileRenderer>> renderers;
+        for (int i = 0; i < pool.get_num_workers(); ++i)
+            renderers.push_back(std::make_unique<FileRenderer>(state, block_size, double_precision));
+
+        std::vector<RenderResult> results(jobs.size());
+        auto start_ticks = juce::Time::getHighResolutionTicks();
+        pool.run((int)jobs.size(), [&](int worker_index, int job_index)
+        {
+            auto& job = jobs[(size_t)job_index];
+            results[(size_t)job_index] = renderers[(size_t)worker_index]->render(job.input, job.output);
+        });
+        auto wall_seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start_ticks);
+
+        auto audio_seconds = 0.0;
+        auto num_failed = 0;
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            auto& result = results[i];
+            if (!result.succeeded)
+            {
+                std::cerr << "Failed: " << result.error << std::endl;
+                ++num_failed;
+                continue;
+            }
+
+            audio_seconds += result.audio_seconds;
+            std::cout << jobs[i].output.getFullPathName() << ": " << juce::String(result.get_realtime_factor(), 1) << "x realtime" << std::endl;
+        }
+
+        std::cout << (int)jobs.size() - num_failed << " files, " << juce::String(audio_seconds, 1) << " s of audio in "
+                  << juce::String(wall_seconds, 1) << " s on " << pool.get_num_workers() << " threads: "
+                  << juce::String(wall_seconds > 0.0 ? audio_seconds / wall_seconds : 0.0, 1) << "x realtime" << std::endl;
+
+        if (num_failed > 0)
+            juce::ConsoleApplication::fail(juce::String(num_failed) + " of " + juce::String((int)jobs.size()) + " files failed");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juce_initialiser;
+
+    juce::ConsoleApplication application;
+    application.addHelpCommand("--help|-h", "Usage: SEQBatchRenderer --output-dir=<folder> [options] <files or folders>...", true);
+
+    application.addDefaultCommand({ "--render",
+                                    "--render --output-dir=<folder> [--state=<file>] [--threads=<cpus>] [--block-size=8192] [--double] <files or folders>...",
+                                    "Runs WAV, FLAC and AIFF files through SEQ with a saved state",
+                                    "The state file is the raw getStateInformation blob, without it the defaults are used. Folders are searched recursively. "
+                                    "Each file is written with the same name, format and bit depth under the output folder, latency compensated.",
+                                    run_render });
+
+    return application.findAndRunCommand(argc, argv);
+}
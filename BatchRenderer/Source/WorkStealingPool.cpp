@@ -0,0 +1,78 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Runs a fixed list of jobs on a handful of threads.
+
+  ==============================================================================
+*/
+
+#include "WorkStealingPool.h"
+
+class WorkStealingPool::Worker : public juce::Thread
+{
+public:
+    Worker(WorkStealingPool& owner, int worker_index, const std::function<void(int, int)>& job)
+        : juce::Thread("SEQ Render Worker " + juce::String(worker_index + 1)), pool(owner), index(worker_index), run_job(job)
+    {
+    }
+
+    void run() override
+    {
+        int job_index;
+        while (!threadShouldExit() && pool.take_job(index, job_index))
+            run_job(index, job_index);
+    }
+
+private:
+    WorkStealingPool& pool;
+    const int index;
+    const std::function<void(int, int)>& run_job;
+};
+
+//==============================================================================
+WorkStealingPool::WorkStealingPool(int num_workers)
+{
+    for (int i = 0; i < juce::jmax(1, num_workers); ++i)
+        queues.push_back(std::make_unique<Queue>());
+}
+
+void WorkStealingPool::run(int num_jobs, const std::function<void(int, int)>& job)
+{
+    for (int job_index = 0; job_index < num_jobs; ++job_index)
+        queues[(size_t)(job_index % get_num_workers())]->jobs.push_back(job_index);
+
+    juce::OwnedArray<Worker> workers;
+    for (int i = 0; i < get_num_workers(); ++i)
+        workers.add(new Worker(*this, i, job))->startThread();
+
+    for (auto* worker : workers)
+        worker->waitForThreadToExit(-1);
+}
+
+bool WorkStealingPool::take_job(int worker_index, int& job_index)
+{
+    // Own queue from the front, then everyone else's from the back, starting with the next worker
+    for (int offset = 0; offset < get_num_workers(); ++offset)
+    {
+        auto& queue = *queues[(size_t)((worker_index + offset) % get_num_workers())];
+        const juce::ScopedLock lock(queue.lock);
+        if (queue.jobs.empty())
+            continue;
+
+        if (offset == 0)
+        {
+            job_index = queue.jobs.front();
+            queue.jobs.pop_front();
+        }
+        else
+        {
+            job_index = queue.jobs.back();
+            queue.jobs.pop_back();
+        }
+        return true;
+    }
+
+    // No job is ever added once the workers run, so empty everywhere means done
+    return false;
+}
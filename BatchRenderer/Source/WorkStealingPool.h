@@ -0,0 +1,45 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Runs a fixed list of jobs on a handful of threads.
+
+    The jobs are dealt out round robin up front, so every worker starts on
+    its own queue without touching the others. A worker that runs dry takes
+    from the back of another worker's queue, which keeps the threads busy
+    to the end even when a few files are much longer than the rest.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <deque>
+
+class WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(int num_workers);
+
+    int get_num_workers() const noexcept { return (int)queues.size(); }
+
+    // Calls job(worker_index, job_index) once for every job and returns when all have finished.
+    // Jobs are started in order on each worker, so put the longest first
+    void run(int num_jobs, const std::function<void(int worker_index, int job_index)>& job);
+
+private:
+    struct Queue
+    {
+        juce::CriticalSection lock;
+        std::deque<int> jobs;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+
+    bool take_job(int worker_index, int& job_index);
+
+    class Worker;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WorkStealingPool)
+};
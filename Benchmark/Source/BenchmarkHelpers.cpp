@@ -0,0 +1,96 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Shared plumbing for the headless commands.
+
+  ==============================================================================
+*/
+
+#include "BenchmarkHelpers.h"
+
+std::unique_ptr<SEQAudioProcessor> create_processor(const ProcessorSetup& setup)
+{
+    auto processor = std::make_unique<SEQAudioProcessor>();
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(setup.num_channels));
+    layout.inputBuses.add(juce::AudioChannelSet::disabled());
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(setup.num_channels));
+    if (!processor->setBusesLayout(layout))
+        juce::ConsoleApplication::fail("Unsupported channel count: " + juce::String(setup.num_channels));
+
+    // Something for every stage to do
+    set_parameter(*processor, LOW_CUT_FREQ, setup.low_cut_freq);
+    for (int band = 0; band < juce::jlimit(0, num_bands, setup.num_active_bands); ++band)
+        set_parameter(*processor, get_band_parameter_id(band, BAND_GAIN), 6.f);
+    set_parameter(*processor, LOW_CUT_SLOPE, (float)setup.cut_slope);
+    set_parameter(*processor, HIGH_CUT_SLOPE, (float)setup.cut_slope);
+    set_parameter(*processor, DESIGN_MODE, (float)setup.filter_design);
+    set_parameter(*processor, LOW_CUT_MODE, setup.multirate_low_cut ? 1.f : 0.f);
+
+    // Threshold at the bottom, so band 1 follows the envelope all the time
+    if (setup.dynamic_band)
+    {
+        set_parameter(*processor, DYNAMIC_SOURCE, (float)dynamic_source::input);
+        set_parameter(*processor, DYNAMIC_THRESHOLD, -60.f);
+    }
+
+    processor->get_stage_profiler().set_enabled(setup.stage_profiler);
+    processor->set_control_rate_override(setup.control_rate);
+
+    processor->setProcessingPrecision(setup.double_precision ? juce::AudioProcessor::doublePrecision : juce::AudioProcessor::singlePrecision);
+    processor->setRateAndBufferSizeDetails(setup.sample_rate, setup.block_size);
+    processor->prepareToPlay(setup.sample_rate, setup.block_size);
+    return processor;
+}
+
+void set_parameter(SEQAudioProcessor& processor, const juce::String& parameter_id, float value)
+{
+    auto* parameter = processor.audio_processor_value_tree_state.getParameter(parameter_id);
+    jassert(parameter != nullptr);
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+juce::Array<int> get_int_list(const juce::ArgumentList& arguments, const juce::String& option, const juce::Array<int>& defaults)
+{
+    if (!arguments.containsOption(option))
+        return defaults;
+
+    juce::Array<int> values;
+    for (auto& token : juce::StringArray::fromTokens(arguments.getValueForOption(option), ",", {}))
+        values.add(token.getIntValue());
+    return values;
+}
+
+double get_double(const juce::ArgumentList& arguments, const juce::String& option, double default_value)
+{
+    return arguments.containsOption(option) ? arguments.getValueForOption(option).getDoubleValue() : default_value;
+}
+
+void fill_with_noise(juce::AudioBuffer<float>& buffer, juce::Random& random)
+{
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+}
+
+double ticks_to_nanoseconds(juce::int64 ticks) noexcept
+{
+    return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9;
+}
+
+void write_json(const juce::ArgumentList& arguments, const juce::var& result)
+{
+    auto json = juce::JSON::toString(result);
+
+    if (arguments.containsOption("--output"))
+    {
+        auto file = arguments.getFileForOption("--output");
+        if (!file.replaceWithText(json))
+            juce::ConsoleApplication::fail("Couldn't write " + file.getFullPathName());
+        return;
+    }
+
+    std::cout << json << std::endl;
+}
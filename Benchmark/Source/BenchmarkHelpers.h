@@ -0,0 +1,45 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Shared plumbing for the headless commands: building a prepared
+    SEQAudioProcessor outside of a host, option parsing and JSON output.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+struct ProcessorSetup
+{
+    double sample_rate{ 48000.0 };
+    int block_size{ 512 };
+    int num_channels{ 2 };
+    slope cut_slope{ slope::slope_12 };
+    design_mode filter_design{ design_mode::bilinear };
+    int num_active_bands{ 1 };
+    float low_cut_freq{ 80.f };
+    bool double_precision{ false };
+    bool dynamic_band{ false };
+    bool stage_profiler{ false };
+    bool multirate_low_cut{ false };
+    int control_rate{ -1 };
+};
+
+// Sets the bus layout and parameters, then calls prepareToPlay
+std::unique_ptr<SEQAudioProcessor> create_processor(const ProcessorSetup&);
+
+void set_parameter(SEQAudioProcessor&, const juce::String& parameter_id, float value);
+
+juce::Array<int> get_int_list(const juce::ArgumentList&, const juce::String& option, const juce::Array<int>& defaults);
+double get_double(const juce::ArgumentList&, const juce::String& option, double default_value);
+
+void fill_with_noise(juce::AudioBuffer<float>&, juce::Random&);
+
+double ticks_to_nanoseconds(juce::int64 ticks) noexcept;
+
+// Writes to --output=<file> if given, otherwise to stdout
+void write_json(const juce::ArgumentList&, const juce::var&);
@@ -0,0 +1,130 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    One CoefficientCache hammered from several threads at once.
+
+    A writer keeps storing cut filters of every slope, so entries with one
+    to four sections keep replacing each other, while readers look up band
+    filters and cuts over the same keys. The key range is a few times the
+    size of the table, so entries are evicted all the time and readers
+    regularly copy one while it's rewritten. Every section a reader gets
+    back is compared with designing it directly, and the command fails on
+    any difference. A copy written past the caller's buffer doesn't always
+    show up as a wrong section, build with AddressSanitizer to catch those.
+
+  ==============================================================================
+*/
+
+#include "Commands.h"
+#include "BenchmarkHelpers.h"
+
+namespace
+{
+    constexpr double sample_rate = 48000.0;
+    constexpr int num_frequencies = 4096;
+
+    bool same_section(const BiquadCoefficients& lhs, const BiquadCoefficients& rhs) noexcept
+    {
+        return lhs.b0 == rhs.b0 && lhs.b1 == rhs.b1 && lhs.b2 == rhs.b2 && lhs.a1 == rhs.a1 && lhs.a2 == rhs.a2;
+    }
+
+    // Cuts of a random slope, from one to four sections. Returns false on a wrong lookup
+    bool check_cut(CoefficientCache& coefficient_cache, juce::Random& random) noexcept
+    {
+        auto frequency = (float)(20 + random.nextInt(num_frequencies));
+        auto cut_slope = static_cast<slope>(random.nextInt(4));
+        auto type = random.nextBool() ? cut_type::high_pass : cut_type::low_pass;
+
+        std::array<BiquadCoefficients, 4> cached, designed;
+        auto num_cached = coefficient_cache.get_cut_filter(design_mode::bilinear, type, sample_rate, frequency, cut_slope, cached.data());
+        auto num_designed = make_cut_filter(design_mode::bilinear, type, sample_rate, frequency, cut_slope, designed.data());
+        if (num_cached != num_designed)
+            return false;
+
+        for (int i = 0; i < num_designed; ++i)
+            if (!same_section(cached[(size_t)i], designed[(size_t)i]))
+                return false;
+        return true;
+    }
+
+    bool check_band(CoefficientCache& coefficient_cache, juce::Random& random) noexcept
+    {
+        BandSettings band;
+        band.freq = (float)(20 + random.nextInt(num_frequencies));
+        band.gain_in_decibels = 0.5f * (float)(random.nextInt(96) - 48);
+        band.quality = 0.05f * (float)(1 + random.nextInt(200));
+        return same_section(coefficient_cache.get_band_filter(design_mode::bilinear, sample_rate, band),
+                            make_band_filter(design_mode::bilinear, sample_rate, band));
+    }
+
+    class CacheThread : public juce::Thread
+    {
+    public:
+        CacheThread(CoefficientCache& cache, bool is_writer, int index)
+            : juce::Thread(juce::String(is_writer ? "SEQ Cache Writer " : "SEQ Cache Reader ") + juce::String(index + 1)),
+              coefficient_cache(cache), writer(is_writer), random(0x5E0 + index)
+        {
+        }
+
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                auto correct = (writer || random.nextBool()) ? check_cut(coefficient_cache, random) : check_band(coefficient_cache, random);
+                ++num_lookups;
+                if (!correct)
+                    ++num_mismatches;
+            }
+        }
+
+        std::atomic<juce::int64> num_lookups{ 0 }, num_mismatches{ 0 };
+
+    private:
+        CoefficientCache& coefficient_cache;
+        bool writer;
+        juce::Random random;
+    };
+}
+
+void run_coefficient_cache_race(const juce::ArgumentList& arguments)
+{
+    auto num_readers = juce::jmax(1, (int)get_double(arguments, "--readers", 3.0));
+    auto seconds = get_double(arguments, "--seconds", 5.0);
+
+    CoefficientCache coefficient_cache;
+    juce::OwnedArray<CacheThread> threads;
+    threads.add(new CacheThread(coefficient_cache, true, 0));
+    for (int i = 0; i < num_readers; ++i)
+        threads.add(new CacheThread(coefficient_cache, false, i));
+
+    for (auto* thread : threads)
+        thread->startThread();
+    juce::Thread::sleep((int)(seconds * 1000.0));
+    for (auto* thread : threads)
+        thread->stopThread(1000);
+
+    juce::Array<juce::var> results;
+    juce::int64 total_mismatches = 0;
+    for (auto* thread : threads)
+    {
+        auto* result = new juce::DynamicObject();
+        result->setProperty("thread", thread->getThreadName());
+        result->setProperty("lookups", thread->num_lookups.load());
+        result->setProperty("mismatches", thread->num_mismatches.load());
+        results.add(result);
+        total_mismatches += thread->num_mismatches.load();
+    }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("benchmark", "coefficient_cache_race");
+    report->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("seconds", seconds);
+    report->setProperty("total_mismatches", total_mismatches);
+    report->setProperty("results", results);
+    write_json(arguments, report);
+
+    if (total_mismatches > 0)
+        juce::ConsoleApplication::fail(juce::String(total_mismatches) + " cache lookups that differ from designing the filter directly");
+}
@@ -0,0 +1,25 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    The commands SEQBenchmark understands, one translation unit each.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+void run_throughput(const juce::ArgumentList&);
+void run_realtime_check(const juce::ArgumentList&);
+void run_design_comparison(const juce::ArgumentList&);
+void run_convolution(const juce::ArgumentList&);
+void run_precision(const juce::ArgumentList&);
+void run_stress(const juce::ArgumentList&);
+void run_state_recall(const juce::ArgumentList&);
+void run_multirate(const juce::ArgumentList&);
+void run_lane_layout(const juce::ArgumentList&);
+void run_scalar_comparison(const juce::ArgumentList&);
+void run_profiler_overhead(const juce::ArgumentList&);
+void run_coefficient_cache_race(const juce::ArgumentList&);
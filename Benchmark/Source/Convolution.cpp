@@ -0,0 +1,113 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Linear phase cost against kernel length and partitioning.
+
+  ==============================================================================
+*/
+
+#include "Commands.h"
+#include "BenchmarkHelpers.h"
+
+namespace
+{
+    struct Partitioning
+    {
+        bool is_uniform;
+        int size;
+    };
+
+    juce::var run_configuration(const juce::AudioBuffer<float>& kernel, Partitioning partitioning, const ProcessorSetup& setup, double seconds)
+    {
+        juce::dsp::ConvolutionMessageQueue queue;
+        auto convolution = partitioning.is_uniform ? std::make_unique<juce::dsp::Convolution>(juce::dsp::Convolution::Latency{ partitioning.size }, queue)
+                                                   : std::make_unique<juce::dsp::Convolution>(juce::dsp::Convolution::NonUniform{ partitioning.size }, queue);
+
+        convolution->loadImpulseResponse(juce::AudioBuffer<float>(kernel), setup.sample_rate, juce::dsp::Convolution::Stereo::no,
+                                         juce::dsp::Convolution::Trim::no, juce::dsp::Convolution::Normalise::no);
+        convolution->prepare({ setup.sample_rate, (juce::uint32)setup.block_size, (juce::uint32)setup.num_channels });
+
+        juce::AudioBuffer<float> noise(setup.num_channels, setup.block_size), buffer(setup.num_channels, setup.block_size);
+        juce::Random random(0x5E0);
+        fill_with_noise(noise, random);
+
+        auto process = [&]
+        {
+            buffer.makeCopyOf(noise, true);
+            juce::dsp::AudioBlock<float> block(buffer);
+            juce::dsp::ProcessContextReplacing<float> context(block);
+            convolution->process(context);
+        };
+
+        // The kernel is swapped in from the queue's thread, keep processing until it's live
+        auto deadline = juce::Time::getMillisecondCounter() + 5000;
+        while (convolution->getCurrentIRSize() != kernel.getNumSamples() && juce::Time::getMillisecondCounter() < deadline)
+        {
+            process();
+            juce::Thread::sleep(1);
+        }
+        for (int i = 0; i < 64; ++i)
+            process();
+
+        auto num_blocks = juce::jmax(1, (int)(seconds * setup.sample_rate / setup.block_size));
+        juce::int64 ticks = 0;
+        for (int i = 0; i < num_blocks; ++i)
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+            process();
+            ticks += juce::Time::getHighResolutionTicks() - start;
+        }
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("kernel_length", kernel.getNumSamples());
+        result->setProperty("partitioning", partitioning.is_uniform ? "uniform" : "non_uniform");
+        result->setProperty("partition_size", partitioning.size);
+        result->setProperty("sample_rate", setup.sample_rate);
+        result->setProperty("block_size", setup.block_size);
+        result->setProperty("channels", setup.num_channels);
+        result->setProperty("latency_samples", kernel.getNumSamples() / 2 + convolution->getLatency());
+        result->setProperty("ns_per_sample", ticks_to_nanoseconds(ticks) / ((double)num_blocks * setup.block_size * setup.num_channels));
+        return result;
+    }
+}
+
+void run_convolution(const juce::ArgumentList& arguments)
+{
+    auto kernel_lengths = get_int_list(arguments, "--kernel-lengths", { 2048, 4096, 8192, 16384, 32768 });
+    auto uniform_sizes = get_int_list(arguments, "--uniform-partitions", { 64, 256, 1024, 4096 });
+    auto head_sizes = get_int_list(arguments, "--non-uniform-heads", { 64, 256, 1024 });
+
+    ProcessorSetup setup;
+    setup.sample_rate = get_double(arguments, "--sample-rate", 48000.0);
+    setup.block_size = (int)get_double(arguments, "--block-size", 512.0);
+    auto seconds = get_double(arguments, "--seconds", 1.0);
+
+    // The same shape create_processor sets up: 80 Hz low cut, a 6 dB peak and the high cut open
+    ChainSettings chain_settings;
+    chain_settings.low_cut_freq = 80.f;
+    chain_settings.high_cut_freq = 20000.f;
+    chain_settings.bands[0].freq = 750.f;
+    chain_settings.bands[0].gain_in_decibels = 6.f;
+    auto coefficient_set = design_coefficients(chain_settings, setup.sample_rate);
+
+    juce::Array<juce::var> results;
+    for (auto kernel_length : kernel_lengths)
+    {
+        if (!juce::isPowerOfTwo(kernel_length))
+            juce::ConsoleApplication::fail("Kernel lengths must be powers of two");
+
+        auto kernel = LinearPhaseFilter::design_kernel(coefficient_set, kernel_length);
+        for (auto size : uniform_sizes)
+            results.add(run_configuration(kernel, { true, size }, setup, seconds));
+        for (auto size : head_sizes)
+            results.add(run_configuration(kernel, { false, size }, setup, seconds));
+    }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("benchmark", "convolution");
+    report->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("results", results);
+    write_json(arguments, report);
+}
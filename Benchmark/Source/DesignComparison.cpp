@@ -0,0 +1,209 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Analog matched design against bilinear design at 1x, 2x and 4x.
+
+    The error curves are the designed sections' response against the analog
+    prototype. For the oversampled rows that is the response of the sections
+    designed at the higher rate only, the half band filters' own ripple and
+    roll off near Nyquist come on top. The CPU rows run the real processor,
+    with juce::dsp::Oversampling around it for the oversampled ones.
+
+  ==============================================================================
+*/
+
+#include "Commands.h"
+#include "BenchmarkHelpers.h"
+
+namespace
+{
+    struct DesignCase
+    {
+        juce::String name;
+        bool is_peak;
+        float frequency, quality, gain_in_decibels;
+        slope cut_slope;
+        cut_type type;
+    };
+
+    double get_analog_magnitude(const DesignCase& design_case, double frequency)
+    {
+        using complex = std::complex<double>;
+        auto s = complex(0.0, frequency / design_case.frequency);
+
+        if (design_case.is_peak)
+        {
+            auto A = std::sqrt((double)juce::Decibels::decibelsToGain(design_case.gain_in_decibels));
+            return std::abs((s * s + s * A / (double)design_case.quality + 1.0) / (s * s + s / (A * design_case.quality) + 1.0));
+        }
+
+        auto magnitude = 1.0;
+        auto numerator = design_case.type == cut_type::high_pass ? s * s : complex(1.0);
+        for (int i = 0; i < get_num_cut_sections(design_case.cut_slope); ++i)
+            magnitude *= std::abs(numerator / (s * s + s / get_butterworth_section_q(design_case.cut_slope, i) + 1.0));
+        return magnitude;
+    }
+
+    double get_digital_magnitude(const DesignCase& design_case, design_mode mode, double sample_rate, double frequency)
+    {
+        std::array<BiquadCoefficients, 4> sections;
+        int num_sections = 1;
+        if (design_case.is_peak)
+            sections[0] = mode == design_mode::analog_matched ? make_matched_peak_filter(sample_rate, design_case.frequency, design_case.quality, design_case.gain_in_decibels)
+                                                              : make_peak_filter(sample_rate, design_case.frequency, design_case.quality, design_case.gain_in_decibels);
+        else
+            num_sections = make_cut_filter(mode, design_case.type, sample_rate, design_case.frequency, design_case.cut_slope, sections.data());
+
+        auto omega = juce::MathConstants<double>::twoPi * frequency / sample_rate;
+        float cos_w = (float)std::cos(omega), cos_2w = (float)std::cos(2.0 * omega), magnitude_squared = 1.f;
+        for (int i = 0; i < num_sections; ++i)
+            multiply_by_magnitude_squared(sections[(size_t)i], &cos_w, &cos_2w, &magnitude_squared, 1);
+        return std::sqrt((double)magnitude_squared);
+    }
+
+    juce::var measure_error(const DesignCase& design_case, double sample_rate, int num_points)
+    {
+        struct Method { const char* name; design_mode mode; int factor; };
+        const Method methods[] = { { "bilinear", design_mode::bilinear, 1 },
+                                   { "analog_matched", design_mode::analog_matched, 1 },
+                                   { "bilinear_2x", design_mode::bilinear, 2 },
+                                   { "bilinear_4x", design_mode::bilinear, 4 } };
+
+        auto top_frequency = juce::jmin(20000.0, sample_rate * 0.49);
+        juce::Array<juce::var> frequencies;
+        for (int i = 0; i < num_points; ++i)
+            frequencies.add(juce::mapToLog10((double)i / (num_points - 1), 20.0, top_frequency));
+
+        auto* errors = new juce::DynamicObject();
+        auto* max_errors = new juce::DynamicObject();
+        for (auto& method : methods)
+        {
+            juce::Array<juce::var> curve;
+            auto max_error = 0.0;
+            for (auto& frequency : frequencies)
+            {
+                auto digital = get_digital_magnitude(design_case, method.mode, sample_rate * method.factor, frequency);
+                auto analog = get_analog_magnitude(design_case, frequency);
+                auto error = 20.0 * std::log10(juce::jmax(digital, 1.0e-9) / juce::jmax(analog, 1.0e-9));
+                curve.add(error);
+                max_error = juce::jmax(max_error, std::abs(error));
+            }
+            errors->setProperty(method.name, curve);
+            max_errors->setProperty(method.name, max_error);
+        }
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("case", design_case.name);
+        result->setProperty("sample_rate", sample_rate);
+        result->setProperty("frequencies", frequencies);
+        result->setProperty("error_db", errors);
+        result->setProperty("max_abs_error_db", max_errors);
+        return result;
+    }
+
+    juce::var measure_cpu(design_mode mode, int oversampling_factor, const ProcessorSetup& base_setup, double seconds)
+    {
+        auto setup = base_setup;
+        setup.filter_design = mode;
+        setup.sample_rate *= oversampling_factor;
+        setup.block_size *= oversampling_factor;
+        auto processor = create_processor(setup);
+
+        // Polyphase IIR half bands, the cheaper of JUCE's two choices
+        std::unique_ptr<juce::dsp::Oversampling<float>> oversampling;
+        if (oversampling_factor > 1)
+        {
+            oversampling = std::make_unique<juce::dsp::Oversampling<float>>((size_t)base_setup.num_channels, (size_t)std::log2(oversampling_factor),
+                                                                            juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true);
+            oversampling->initProcessing((size_t)base_setup.block_size);
+        }
+
+        juce::AudioBuffer<float> noise(base_setup.num_channels, base_setup.block_size), buffer(base_setup.num_channels, base_setup.block_size);
+        juce::Random random(0x5E0);
+        fill_with_noise(noise, random);
+        juce::MidiBuffer midi;
+        std::vector<float*> channel_pointers((size_t)base_setup.num_channels);
+
+        auto process = [&]
+        {
+            buffer.makeCopyOf(noise, true);
+            if (oversampling == nullptr)
+            {
+                processor->processBlock(buffer, midi);
+                return;
+            }
+
+            juce::dsp::AudioBlock<float> block(buffer);
+            auto oversampled = oversampling->processSamplesUp(block);
+            for (size_t channel = 0; channel < channel_pointers.size(); ++channel)
+                channel_pointers[channel] = oversampled.getChannelPointer(channel);
+            juce::AudioBuffer<float> oversampled_buffer(channel_pointers.data(), (int)channel_pointers.size(), (int)oversampled.getNumSamples());
+            processor->processBlock(oversampled_buffer, midi);
+            oversampling->processSamplesDown(block);
+        };
+
+        auto num_blocks = juce::jmax(1, (int)(seconds * base_setup.sample_rate / base_setup.block_size));
+        for (int i = 0; i < 16; ++i)
+            process();
+
+        juce::int64 ticks = 0;
+        for (int i = 0; i < num_blocks; ++i)
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+            process();
+            ticks += juce::Time::getHighResolutionTicks() - start;
+        }
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("design", mode == design_mode::analog_matched ? "analog_matched" : "bilinear");
+        result->setProperty("oversampling", oversampling_factor);
+        result->setProperty("sample_rate", base_setup.sample_rate);
+        result->setProperty("block_size", base_setup.block_size);
+        result->setProperty("channels", base_setup.num_channels);
+        result->setProperty("ns_per_sample", ticks_to_nanoseconds(ticks) / ((double)num_blocks * base_setup.block_size * base_setup.num_channels));
+        return result;
+    }
+}
+
+void run_design_comparison(const juce::ArgumentList& arguments)
+{
+    auto sample_rates = get_int_list(arguments, "--sample-rates", { 44100, 48000, 96000 });
+    auto num_points = juce::jmax(2, (int)get_double(arguments, "--points", 64.0));
+    auto seconds = get_double(arguments, "--seconds", 1.0);
+
+    const DesignCase cases[] = {
+        { "peak 1 kHz Q1 +12 dB", true, 1000.f, 1.f, 12.f, slope::slope_12, cut_type::high_pass },
+        { "peak 5 kHz Q1 +12 dB", true, 5000.f, 1.f, 12.f, slope::slope_12, cut_type::high_pass },
+        { "peak 10 kHz Q1 +12 dB", true, 10000.f, 1.f, 12.f, slope::slope_12, cut_type::high_pass },
+        { "peak 15 kHz Q2 -12 dB", true, 15000.f, 2.f, -12.f, slope::slope_12, cut_type::high_pass },
+        { "peak 18 kHz Q0.7 +6 dB", true, 18000.f, 0.7f, 6.f, slope::slope_12, cut_type::high_pass },
+        { "low cut 10 kHz 12 dB/Oct", false, 10000.f, 0.f, 0.f, slope::slope_12, cut_type::high_pass },
+        { "low cut 15 kHz 48 dB/Oct", false, 15000.f, 0.f, 0.f, slope::slope_48, cut_type::high_pass },
+        { "high cut 10 kHz 12 dB/Oct", false, 10000.f, 0.f, 0.f, slope::slope_12, cut_type::low_pass },
+        { "high cut 15 kHz 48 dB/Oct", false, 15000.f, 0.f, 0.f, slope::slope_48, cut_type::low_pass }
+    };
+
+    juce::Array<juce::var> error_results;
+    for (auto sample_rate : sample_rates)
+        for (auto& design_case : cases)
+            error_results.add(measure_error(design_case, sample_rate, num_points));
+
+    ProcessorSetup setup;
+    setup.sample_rate = sample_rates[0];
+    setup.cut_slope = slope::slope_48;
+
+    juce::Array<juce::var> cpu_results;
+    cpu_results.add(measure_cpu(design_mode::bilinear, 1, setup, seconds));
+    cpu_results.add(measure_cpu(design_mode::analog_matched, 1, setup, seconds));
+    cpu_results.add(measure_cpu(design_mode::bilinear, 2, setup, seconds));
+    cpu_results.add(measure_cpu(design_mode::bilinear, 4, setup, seconds));
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("benchmark", "design_comparison");
+    report->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("error", error_results);
+    report->setProperty("cpu_cost", cpu_results);
+    write_json(arguments, report);
+}
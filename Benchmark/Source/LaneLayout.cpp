@@ -0,0 +1,170 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    The band engine with channels in the lanes against samples in the lanes.
+
+    SIMDFilterChain is run on its own, in float, for mono and stereo at
+    each block size, once interleaved and once time blocked. Both see the
+    same noise as a double interleaved chain, which is the reference. The
+    time blocked kernel is expected to stay within time_blocked_bound_db of
+    the interleaved kernel's error, and the command fails if it doesn't.
+
+  ==============================================================================
+*/
+
+#include "Commands.h"
+#include "BenchmarkHelpers.h"
+
+namespace
+{
+    using lane_layout = SIMDFilterChain<float>::lane_layout;
+
+    // Float rounding is the error either way, a different kernel may move it a little but not more
+    constexpr double time_blocked_bound_db = 3.0;
+
+    template <typename SampleType>
+    double run_chain(typename SIMDFilterChain<SampleType>::lane_layout layout, const CoefficientSet& coefficient_set, const ProcessorSetup& setup,
+                     const juce::AudioBuffer<double>& input, juce::AudioBuffer<double>& output)
+    {
+        SIMDFilterChain<SampleType> chain;
+        chain.set_lane_layout(layout);
+        chain.prepare({ setup.sample_rate, (juce::uint32)setup.block_size, (juce::uint32)setup.num_channels });
+        chain.update(coefficient_set);
+
+        juce::AudioBuffer<SampleType> buffer(setup.num_channels, setup.block_size);
+        static constexpr int num_warm_up_blocks = 16;
+        juce::int64 ticks = 0;
+        int num_timed_samples = 0;
+        for (int block = 0; (block + 1) * setup.block_size <= input.getNumSamples(); ++block)
+        {
+            auto position = block * setup.block_size;
+            for (int channel = 0; channel < setup.num_channels; ++channel)
+                for (int i = 0; i < setup.block_size; ++i)
+                    buffer.setSample(channel, i, (SampleType)input.getSample(channel, position + i));
+
+            auto start = juce::Time::getHighResolutionTicks();
+            chain.process(juce::dsp::AudioBlock<SampleType>(buffer));
+            auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+            if (block >= num_warm_up_blocks)
+            {
+                ticks += elapsed;
+                num_timed_samples += setup.block_size;
+            }
+
+            for (int channel = 0; channel < setup.num_channels; ++channel)
+                for (int i = 0; i < setup.block_size; ++i)
+                    output.setSample(channel, position + i, (double)buffer.getSample(channel, i));
+        }
+
+        return ticks_to_nanoseconds(ticks) / juce::jmax(1.0, (double)num_timed_samples * setup.num_channels);
+    }
+
+    // Level of the difference relative to the reference, in dB
+    double get_error_in_decibels(const juce::AudioBuffer<double>& output, const juce::AudioBuffer<double>& reference)
+    {
+        auto error_energy = 0.0, reference_energy = 0.0;
+        for (int channel = 0; channel < reference.getNumChannels(); ++channel)
+        {
+            for (int i = 0; i < reference.getNumSamples(); ++i)
+            {
+                auto difference = output.getSample(channel, i) - reference.getSample(channel, i);
+                error_energy += difference * difference;
+                reference_energy += reference.getSample(channel, i) * reference.getSample(channel, i);
+            }
+        }
+
+        return 10.0 * std::log10(juce::jmax(error_energy, 1.0e-300) / juce::jmax(reference_energy, 1.0e-300));
+    }
+
+    juce::var run_configuration(const CoefficientSet& coefficient_set, const ProcessorSetup& setup, double seconds, bool& within_bound)
+    {
+        auto num_samples = juce::jmax(64, (int)(seconds * setup.sample_rate / setup.block_size)) * setup.block_size;
+        juce::AudioBuffer<double> input(setup.num_channels, num_samples), reference(setup.num_channels, num_samples);
+        juce::AudioBuffer<double> interleaved(setup.num_channels, num_samples), time_blocked(setup.num_channels, num_samples);
+        juce::Random random(0x5E0);
+        for (int channel = 0; channel < setup.num_channels; ++channel)
+            for (int i = 0; i < num_samples; ++i)
+                input.setSample(channel, i, random.nextDouble() * 2.0 - 1.0);
+
+        run_chain<double>(SIMDFilterChain<double>::lane_layout::interleaved, coefficient_set, setup, input, reference);
+        auto interleaved_ns = run_chain<float>(lane_layout::interleaved, coefficient_set, setup, input, interleaved);
+        auto time_blocked_ns = run_chain<float>(lane_layout::time_blocked, coefficient_set, setup, input, time_blocked);
+
+        auto interleaved_error = get_error_in_decibels(interleaved, reference);
+        auto time_blocked_error = get_error_in_decibels(time_blocked, reference);
+        within_bound = time_blocked_error <= interleaved_error + time_blocked_bound_db;
+
+        auto* cpu = new juce::DynamicObject();
+        cpu->setProperty("interleaved", interleaved_ns);
+        cpu->setProperty("time_blocked", time_blocked_ns);
+
+        auto* error = new juce::DynamicObject();
+        error->setProperty("interleaved", interleaved_error);
+        error->setProperty("time_blocked", time_blocked_error);
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("sections", coefficient_set.num_sections);
+        result->setProperty("block_size", setup.block_size);
+        result->setProperty("channels", setup.num_channels);
+        result->setProperty("ns_per_sample", cpu);
+        result->setProperty("error_db_vs_double", error);
+        result->setProperty("within_bound", within_bound);
+        return result;
+    }
+}
+
+void run_lane_layout(const juce::ArgumentList& arguments)
+{
+    auto block_sizes = get_int_list(arguments, "--block-sizes", { 64, 128, 256, 512, 1024 });
+    auto channel_counts = get_int_list(arguments, "--channels", { 1, 2 });
+    auto active_bands = get_int_list(arguments, "--active-bands", { 1, 8 });
+
+    ProcessorSetup setup;
+    setup.sample_rate = get_double(arguments, "--sample-rate", 48000.0);
+    auto seconds = get_double(arguments, "--seconds", 2.0);
+
+    juce::Array<juce::var> results;
+    int num_out_of_bound = 0;
+    for (auto num_bands_in_use : active_bands)
+    {
+        // A steep low cut at 20 Hz is the hard case for float, high cut and bands as create_processor sets them
+        ChainSettings chain_settings;
+        chain_settings.low_cut_freq = 20.f;
+        chain_settings.high_cut_freq = 18000.f;
+        chain_settings.low_cut_slope = chain_settings.high_cut_slope = slope::slope_48;
+        for (int band = 0; band < juce::jlimit(0, num_bands, num_bands_in_use); ++band)
+        {
+            chain_settings.bands[(size_t)band].freq = 60.f * std::pow(2.f, (float)band);
+            chain_settings.bands[(size_t)band].gain_in_decibels = 6.f;
+        }
+        auto coefficient_set = design_coefficients(chain_settings, setup.sample_rate);
+
+        for (auto num_channels : channel_counts)
+            for (auto block_size : block_sizes)
+            {
+                setup.num_channels = juce::jlimit(1, SIMDFilterChain<float>::max_channels, num_channels);
+                setup.block_size = block_size;
+
+                auto within_bound = true;
+                results.add(run_configuration(coefficient_set, setup, seconds, within_bound));
+                if (!within_bound)
+                    ++num_out_of_bound;
+            }
+    }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("benchmark", "lane_layout");
+    report->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("lanes", (int)SIMDFilterChain<float>::get_num_lanes());
+    report->setProperty("sample_rate", setup.sample_rate);
+    report->setProperty("time_blocked_bound_db", time_blocked_bound_db);
+    report->setProperty("results", results);
+    write_json(arguments, report);
+
+    if (num_out_of_bound > 0)
+        juce::ConsoleApplication::fail(juce::String(num_out_of_bound) + " configurations where the time blocked kernel is more than "
+                                       + juce::String(time_blocked_bound_db) + " dB less accurate than the interleaved one");
+}
@@ -0,0 +1,94 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    SEQBenchmark: headless measurements of the SEQ processor, reported as
+    JSON so results can be compared between releases.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Commands.h"
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juce_initialiser;
+
+    juce::ConsoleApplication application;
+    application.addHelpCommand("--help|-h", "Usage: SEQBenchmark <command> [options]", true);
+
+    application.addCommand({ "--throughput",
+                             "--throughput [--sample-rates=44100,...] [--block-sizes=16,...] [--channels=1,...] [--slopes=12,...] [--active-bands=0,...] [--silence] [--dynamic] [--profile] [--automation [--control-rates=0,1,...]] [--seconds=1] [--output=file.json]",
+                             "Sweeps processBlock over sample rate, block size, channel count, slope and active band count",
+                             "Reports ns/sample, samples/sec, the realtime factor and, where perf counters are available, instructions per sample.",
+                             run_throughput });
+
+    application.addCommand({ "--realtime-check",
+                             "--realtime-check [--sample-rates=44100,...] [--block-sizes=32,...] [--channels=1,...] [--blocks=2000] [--output=file.json]",
+                             "Fails on any allocation, free or mutex lock inside processBlock",
+                             "Drives prepareToPlay, processBlock and setStateInformation under random automation. Needs the RealtimeCheck configuration (SEQ_REALTIME_CHECKS=1).",
+                             run_realtime_check });
+
+    application.addCommand({ "--design-comparison",
+                             "--design-comparison [--sample-rates=44100,...] [--points=64] [--seconds=1] [--output=file.json]",
+                             "Compares analog matched design with bilinear design at 1x, 2x and 4x oversampling",
+                             "Reports the magnitude error against the analog prototypes on a log frequency grid, and the CPU cost of each option.",
+                             run_design_comparison });
+
+    application.addCommand({ "--convolution",
+                             "--convolution [--kernel-lengths=2048,...] [--uniform-partitions=64,...] [--non-uniform-heads=64,...] [--sample-rate=48000] [--block-size=512] [--seconds=1] [--output=file.json]",
+                             "Measures the linear phase mode against kernel length and partitioning",
+                             "Reports ns/sample and the total latency for each kernel length with uniform and non-uniform partitions.",
+                             run_convolution });
+
+    application.addCommand({ "--precision",
+                             "--precision [--low-cut-freqs=20,...] [--slopes=12,...] [--sample-rate=48000] [--block-size=512] [--channels=2] [--seconds=2] [--output=file.json]",
+                             "Compares the float path, the native double path and a double host feeding the float path",
+                             "Reports ns/sample for each path and how far the float outputs are from the double output, in dB below the signal.",
+                             run_precision });
+
+    application.addCommand({ "--stress",
+                             "--stress [--automation=lanes.json | --seed=1504] [--save-automation=lanes.json] [--sample-rate=48000] [--block-size=128] [--channels=2] [--seconds=10] [--deadline=0.5] [--load-threads=n] [--pin-core=0] [--output=file.json]",
+                             "Replays parameter automation and measures every block's processing time",
+                             "Reports a histogram, p50/p99/p99.9/max and the blocks over --deadline times the buffer period, free and pinned, with and without background load.",
+                             run_stress });
+
+    application.addCommand({ "--state-recall",
+                             "--state-recall [--instances=300] [--sample-rate=48000] [--block-size=512] [--channels=2] [--output=file.json]",
+                             "Measures what opening a session costs per instance, for the binary and the ValueTree state",
+                             "Reports the average time to construct, restore, prepare and run the first two blocks, restoring before and after prepare.",
+                             run_state_recall });
+
+    application.addCommand({ "--multirate",
+                             "--multirate [--sample-rates=48000,...] [--low-cut-freqs=20,...] [--slopes=48,...] [--test-freqs=10,...] [--block-size=512] [--channels=2] [--seconds=2] [--output=file.json]",
+                             "Compares the full rate low cut with the multirate one",
+                             "Reports ns/sample, the latency and the error against the analog Butterworth high pass at each test frequency, for both Low Cut Modes.",
+                             run_multirate });
+
+    application.addCommand({ "--lane-layout",
+                             "--lane-layout [--block-sizes=64,...] [--channels=1,...] [--active-bands=1,...] [--sample-rate=48000] [--seconds=2] [--output=file.json]",
+                             "Compares the band engine with channels in the SIMD lanes against consecutive samples in the lanes",
+                             "Reports ns/sample and the error against a double chain for both kernels, and fails if the time blocked one is out of its error bound.",
+                             run_lane_layout });
+
+    application.addCommand({ "--scalar-comparison",
+                             "--scalar-comparison [--channels=1,...] [--active-bands=1,...] [--float-tolerance=-50] [--double-tolerance=-200] [--sample-rate=48000] [--block-size=512] [--seconds=1] [--output=file.json]",
+                             "Compares the SIMD band engine with the per channel juce::dsp::IIR chain it replaced",
+                             "Reports ns/sample for both, the speedup and the difference in dB and max abs in float and double, and fails if the difference is above the tolerance.",
+                             run_scalar_comparison });
+
+    application.addCommand({ "--profiler-overhead",
+                             "--profiler-overhead [--block-sizes=64,...] [--channels=1,...] [--active-bands=1,...] [--max-overhead=1] [--rounds=10] [--sample-rate=48000] [--seconds=2] [--output=file.json]",
+                             "Measures what the stage profiler adds to processBlock while it records",
+                             "Reports ns/sample with the profiler off and on and the overhead in percent, and fails if it's above --max-overhead.",
+                             run_profiler_overhead });
+
+    application.addCommand({ "--coefficient-cache-race",
+                             "--coefficient-cache-race [--readers=3] [--seconds=5] [--output=file.json]",
+                             "Stores and looks up cached filter sections from several threads at once",
+                             "A writer stores cuts of one to four sections while readers look up bands and cuts, and the command fails if any lookup differs from designing directly.",
+                             run_coefficient_cache_race });
+
+    return application.findAndRunCommand(argc, argv);
+}
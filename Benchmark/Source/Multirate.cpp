@@ -0,0 +1,166 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    The full rate low cut against the multirate one at high sample rates.
+
+    Both Low Cut Modes run the float path at every rate with only the cut
+    filters in the chain. The CPU cost is timed on noise. The response is
+    measured one sine at a time: once the filter has settled, the output is
+    correlated with the input over whole cycles, the latency is taken back
+    out and the result is compared with the analog Butterworth high pass it
+    was designed from. 48 kHz is the control, both modes are the same there.
+
+  ==============================================================================
+*/
+
+#include "Commands.h"
+#include "BenchmarkHelpers.h"
+
+namespace
+{
+    using complex = std::complex<double>;
+
+    complex get_butterworth_high_pass(double frequency, double cut_frequency, slope cut_slope)
+    {
+        auto order = 2 * ((int)cut_slope + 1);
+        auto s = complex(0.0, frequency / cut_frequency);
+        complex response(1.0);
+        for (int i = 0; i < order / 2; ++i)
+        {
+            auto quality = 1.0 / (2.0 * std::sin(juce::MathConstants<double>::pi * (2 * i + 1) / (2 * order)));
+            response *= s * s / (s * s + s / quality + 1.0);
+        }
+        return response;
+    }
+
+    // The sine's phasor over num_samples from start, whole cycles for whole number frequencies
+    complex get_phasor(const float* samples, int start, int num_samples, double frequency, double sample_rate)
+    {
+        complex sum;
+        for (int i = start; i < start + num_samples; ++i)
+            sum += (double)samples[i] * std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency * i / sample_rate);
+        return sum * (2.0 / num_samples);
+    }
+
+    double measure_ns_per_sample(const ProcessorSetup& setup, double seconds)
+    {
+        auto processor = create_processor(setup);
+        juce::AudioBuffer<float> noise(setup.num_channels, setup.block_size), buffer(setup.num_channels, setup.block_size);
+        juce::Random random(0x5E0);
+        juce::MidiBuffer midi;
+
+        static constexpr int num_warm_up_blocks = 16;
+        auto num_blocks = juce::jmax(64, (int)(seconds * setup.sample_rate / setup.block_size));
+        juce::int64 ticks = 0;
+        for (int block = 0; block < num_warm_up_blocks + num_blocks; ++block)
+        {
+            fill_with_noise(noise, random);
+            buffer.makeCopyOf(noise, true);
+
+            auto start = juce::Time::getHighResolutionTicks();
+            processor->processBlock(buffer, midi);
+            if (block >= num_warm_up_blocks)
+                ticks += juce::Time::getHighResolutionTicks() - start;
+        }
+
+        return ticks_to_nanoseconds(ticks) / ((double)num_blocks * setup.block_size * setup.num_channels);
+    }
+
+    // Worst magnitude error and worst complex error against the analog prototype, in dB
+    juce::var measure_response(const ProcessorSetup& setup, const juce::Array<int>& test_freqs, int& latency_samples)
+    {
+        // One second to settle, then one second of whole cycles to measure
+        auto second = (int)setup.sample_rate;
+        auto num_blocks = (2 * second + setup.block_size - 1) / setup.block_size;
+        juce::AudioBuffer<float> input(1, num_blocks * setup.block_size), output(1, num_blocks * setup.block_size);
+        juce::AudioBuffer<float> buffer(setup.num_channels, setup.block_size);
+        juce::MidiBuffer midi;
+
+        auto worst_magnitude = 0.0, worst_error = -300.0;
+        auto* per_frequency = new juce::DynamicObject();
+        for (auto test_freq : test_freqs)
+        {
+            // A fresh instance for every sine, so nothing is left ringing from the last one
+            auto processor = create_processor(setup);
+            latency_samples = processor->getLatencySamples();
+
+            auto frequency = (double)test_freq;
+            for (int i = 0; i < input.getNumSamples(); ++i)
+                input.setSample(0, i, (float)(0.5 * std::sin(juce::MathConstants<double>::twoPi * frequency * i / setup.sample_rate)));
+
+            for (int block = 0; block < num_blocks; ++block)
+            {
+                for (int channel = 0; channel < setup.num_channels; ++channel)
+                    buffer.copyFrom(channel, 0, input, 0, block * setup.block_size, setup.block_size);
+                processor->processBlock(buffer, midi);
+                output.copyFrom(0, block * setup.block_size, buffer, 0, 0, setup.block_size);
+            }
+
+            auto measured = get_phasor(output.getReadPointer(0), second, second, frequency, setup.sample_rate)
+                          / get_phasor(input.getReadPointer(0), second, second, frequency, setup.sample_rate)
+                          * std::polar(1.0, juce::MathConstants<double>::twoPi * frequency * latency_samples / setup.sample_rate);
+            auto expected = get_butterworth_high_pass(frequency, setup.low_cut_freq, setup.cut_slope);
+
+            auto magnitude_error = juce::Decibels::gainToDecibels(std::abs(measured) / std::abs(expected), -300.0);
+            auto error = juce::Decibels::gainToDecibels(std::abs(measured - expected), -300.0);
+            worst_magnitude = juce::jmax(worst_magnitude, std::abs(magnitude_error));
+            worst_error = juce::jmax(worst_error, error);
+            per_frequency->setProperty(juce::String(test_freq), magnitude_error);
+        }
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("max_magnitude_error_db", worst_magnitude);
+        result->setProperty("max_error_db", worst_error);
+        result->setProperty("magnitude_error_db", per_frequency);
+        return result;
+    }
+}
+
+void run_multirate(const juce::ArgumentList& arguments)
+{
+    auto sample_rates = get_int_list(arguments, "--sample-rates", { 48000, 96000, 192000 });
+    auto low_cut_freqs = get_int_list(arguments, "--low-cut-freqs", { 20, 40, 80 });
+    auto slopes = get_int_list(arguments, "--slopes", { 48 });
+    auto test_freqs = get_int_list(arguments, "--test-freqs", { 10, 14, 20, 28, 40, 56, 80, 113, 160, 320, 1000 });
+
+    ProcessorSetup setup;
+    setup.block_size = (int)get_double(arguments, "--block-size", 512.0);
+    setup.num_channels = (int)get_double(arguments, "--channels", 2.0);
+    setup.num_active_bands = 0;
+    auto seconds = get_double(arguments, "--seconds", 2.0);
+
+    juce::Array<juce::var> results;
+    for (auto sample_rate : sample_rates)
+        for (auto low_cut_freq : low_cut_freqs)
+            for (auto slope_db : slopes)
+                for (auto multirate : { false, true })
+                {
+                    setup.sample_rate = (double)sample_rate;
+                    setup.low_cut_freq = (float)low_cut_freq;
+                    setup.cut_slope = static_cast<slope>(juce::jlimit(0, 3, slope_db / 12 - 1));
+                    setup.multirate_low_cut = multirate;
+
+                    int latency_samples = 0;
+                    auto response = measure_response(setup, test_freqs, latency_samples);
+
+                    auto* result = new juce::DynamicObject();
+                    result->setProperty("low_cut_mode", multirate ? "multirate" : "full_rate");
+                    result->setProperty("sample_rate", setup.sample_rate);
+                    result->setProperty("low_cut_freq", setup.low_cut_freq);
+                    result->setProperty("slope_db_per_oct", 12 * ((int)setup.cut_slope + 1));
+                    result->setProperty("latency_samples", latency_samples);
+                    result->setProperty("ns_per_sample", measure_ns_per_sample(setup, seconds));
+                    result->setProperty("response", response);
+                    results.add(result);
+                }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("benchmark", "multirate");
+    report->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("block_size", setup.block_size);
+    report->setProperty("channels", setup.num_channels);
+    report->setProperty("results", results);
+    write_json(arguments, report);
+}
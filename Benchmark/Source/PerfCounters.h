@@ -0,0 +1,73 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Retired-instruction counter for the calling thread, backed by
+    perf_event_open on Linux. Everywhere else, or when the kernel refuses
+    (perf_event_paranoid, containers...), is_available() returns false.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_LINUX
+ #include <linux/perf_event.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+class InstructionCounter
+{
+public:
+    InstructionCounter()
+    {
+       #if JUCE_LINUX
+        perf_event_attr attributes{};
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        file_descriptor = (int)syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+       #endif
+    }
+
+    ~InstructionCounter()
+    {
+       #if JUCE_LINUX
+        if (is_available())
+            close(file_descriptor);
+       #endif
+    }
+
+    bool is_available() const noexcept { return file_descriptor >= 0; }
+
+    void start() noexcept
+    {
+       #if JUCE_LINUX
+        ioctl(file_descriptor, PERF_EVENT_IOC_RESET, 0);
+        ioctl(file_descriptor, PERF_EVENT_IOC_ENABLE, 0);
+       #endif
+    }
+
+    juce::uint64 stop() noexcept
+    {
+        juce::uint64 count = 0;
+       #if JUCE_LINUX
+        ioctl(file_descriptor, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(file_descriptor, &count, sizeof(count)) != (ssize_t)sizeof(count))
+            count = 0;
+       #endif
+        return count;
+    }
+
+private:
+    int file_descriptor{ -1 };
+
+    JUCE_DECLARE_NON_COPYABLE(InstructionCounter)
+};
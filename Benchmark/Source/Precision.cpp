@@ -0,0 +1,175 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Float against double processing.
+
+    Three paths see the same noise: a float host with the float path, a
+    double host with the native double path, and a double host converting
+    around the float path, which is what every double host had to do before
+    SEQ supported double precision. The double output is the reference the
+    float outputs are measured against.
+
+  ==============================================================================
+*/
+
+#include "Commands.h"
+#include "BenchmarkHelpers.h"
+
+namespace
+{
+    struct Path
+    {
+        const char* name;
+        bool double_host, double_precision;
+    };
+
+    template <typename Source, typename Destination>
+    void copy_samples(const juce::AudioBuffer<Source>& source, int source_start, juce::AudioBuffer<Destination>& destination, int destination_start, int num_samples)
+    {
+        for (int channel = 0; channel < source.getNumChannels(); ++channel)
+        {
+            auto* from = source.getReadPointer(channel, source_start);
+            auto* to = destination.getWritePointer(channel, destination_start);
+            for (int i = 0; i < num_samples; ++i)
+                to[i] = (Destination)from[i];
+        }
+    }
+
+    // Processes the whole input block by block, the first few blocks aren't timed
+    double run_path(const Path& path, const ProcessorSetup& base_setup, const juce::AudioBuffer<double>& input, juce::AudioBuffer<double>& output)
+    {
+        auto setup = base_setup;
+        setup.double_precision = path.double_precision;
+        auto processor = create_processor(setup);
+
+        juce::AudioBuffer<float> float_block(setup.num_channels, setup.block_size);
+        juce::AudioBuffer<double> double_block(setup.num_channels, setup.block_size);
+        juce::MidiBuffer midi;
+
+        static constexpr int num_warm_up_blocks = 16;
+        juce::int64 ticks = 0;
+        int num_timed_samples = 0;
+        for (int block = 0; (block + 1) * setup.block_size <= input.getNumSamples(); ++block)
+        {
+            auto position = block * setup.block_size;
+            if (path.double_host)
+                copy_samples(input, position, double_block, 0, setup.block_size);
+            else
+                copy_samples(input, position, float_block, 0, setup.block_size);
+
+            auto start = juce::Time::getHighResolutionTicks();
+            if (path.double_precision)
+            {
+                processor->processBlock(double_block, midi);
+            }
+            else if (path.double_host)
+            {
+                float_block.makeCopyOf(double_block, true);
+                processor->processBlock(float_block, midi);
+                double_block.makeCopyOf(float_block, true);
+            }
+            else
+            {
+                processor->processBlock(float_block, midi);
+            }
+            auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+            if (block >= num_warm_up_blocks)
+            {
+                ticks += elapsed;
+                num_timed_samples += setup.block_size;
+            }
+
+            if (path.double_host)
+                copy_samples(double_block, 0, output, position, setup.block_size);
+            else
+                copy_samples(float_block, 0, output, position, setup.block_size);
+        }
+
+        processor->releaseResources();
+        return ticks_to_nanoseconds(ticks) / juce::jmax(1.0, (double)num_timed_samples * setup.num_channels);
+    }
+
+    // Level of the difference relative to the reference, in dB
+    double get_error_in_decibels(const juce::AudioBuffer<double>& output, const juce::AudioBuffer<double>& reference)
+    {
+        auto error_energy = 0.0, reference_energy = 0.0;
+        for (int channel = 0; channel < reference.getNumChannels(); ++channel)
+        {
+            for (int i = 0; i < reference.getNumSamples(); ++i)
+            {
+                auto difference = output.getSample(channel, i) - reference.getSample(channel, i);
+                error_energy += difference * difference;
+                reference_energy += reference.getSample(channel, i) * reference.getSample(channel, i);
+            }
+        }
+
+        return 10.0 * std::log10(juce::jmax(error_energy, 1.0e-300) / juce::jmax(reference_energy, 1.0e-300));
+    }
+
+    juce::var run_configuration(const ProcessorSetup& setup, double seconds)
+    {
+        const Path paths[] = { { "float", false, false },
+                               { "double", true, true },
+                               { "double_host_float_path", true, false } };
+
+        auto num_samples = juce::jmax(64, (int)(seconds * setup.sample_rate / setup.block_size)) * setup.block_size;
+        juce::AudioBuffer<double> input(setup.num_channels, num_samples);
+        juce::Random random(0x5E0);
+        for (int channel = 0; channel < setup.num_channels; ++channel)
+            for (int i = 0; i < num_samples; ++i)
+                input.setSample(channel, i, random.nextDouble() * 2.0 - 1.0);
+
+        std::vector<juce::AudioBuffer<double>> outputs;
+        auto* cpu = new juce::DynamicObject();
+        for (auto& path : paths)
+        {
+            outputs.emplace_back(setup.num_channels, num_samples);
+            cpu->setProperty(path.name, run_path(path, setup, input, outputs.back()));
+        }
+
+        auto& reference = outputs[1];
+        auto* error = new juce::DynamicObject();
+        error->setProperty("float", get_error_in_decibels(outputs[0], reference));
+        error->setProperty("double_host_float_path", get_error_in_decibels(outputs[2], reference));
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("low_cut_freq", setup.low_cut_freq);
+        result->setProperty("slope_db_per_oct", 12 * ((int)setup.cut_slope + 1));
+        result->setProperty("sample_rate", setup.sample_rate);
+        result->setProperty("block_size", setup.block_size);
+        result->setProperty("channels", setup.num_channels);
+        result->setProperty("ns_per_sample", cpu);
+        result->setProperty("error_db_vs_double", error);
+        return result;
+    }
+}
+
+void run_precision(const juce::ArgumentList& arguments)
+{
+    auto low_cut_freqs = get_int_list(arguments, "--low-cut-freqs", { 20, 80 });
+    auto slopes = get_int_list(arguments, "--slopes", { 12, 48 });
+
+    ProcessorSetup setup;
+    setup.sample_rate = get_double(arguments, "--sample-rate", 48000.0);
+    setup.block_size = (int)get_double(arguments, "--block-size", 512.0);
+    setup.num_channels = (int)get_double(arguments, "--channels", 2.0);
+    auto seconds = get_double(arguments, "--seconds", 2.0);
+
+    juce::Array<juce::var> results;
+    for (auto low_cut_freq : low_cut_freqs)
+        for (auto slope_db : slopes)
+        {
+            setup.low_cut_freq = (float)low_cut_freq;
+            setup.cut_slope = static_cast<slope>(juce::jlimit(0, 3, slope_db / 12 - 1));
+            results.add(run_configuration(setup, seconds));
+        }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("benchmark", "precision");
+    report->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("results", results);
+    write_json(arguments, report);
+}
@@ -0,0 +1,120 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    What switching the stage profiler on costs processBlock.
+
+    Two processors with the same settings run the same noise, one with the
+    profiler off and one recording. They take turns for a number of rounds
+    and the fastest round of each is compared, so a slow moment on a busy
+    machine doesn't land on one side only. The command fails if the
+    profiler adds more than --max-overhead percent anywhere.
+
+  ==============================================================================
+*/
+
+#include "Commands.h"
+#include "BenchmarkHelpers.h"
+
+namespace
+{
+    double measure_round(SEQAudioProcessor& processor, const ProcessorSetup& setup, const juce::AudioBuffer<float>& noise, int num_blocks)
+    {
+        juce::AudioBuffer<float> buffer(setup.num_channels, setup.block_size);
+        juce::MidiBuffer midi;
+
+        juce::int64 ticks = 0;
+        for (int block = 0; block < num_blocks; ++block)
+        {
+            buffer.makeCopyOf(noise, true);
+            auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock(buffer, midi);
+            ticks += juce::Time::getHighResolutionTicks() - start;
+        }
+
+        return ticks_to_nanoseconds(ticks) / ((double)num_blocks * setup.block_size * setup.num_channels);
+    }
+
+    juce::var run_configuration(ProcessorSetup setup, double seconds, int num_rounds, double max_overhead, bool& within_bound)
+    {
+        setup.stage_profiler = false;
+        auto processor_off = create_processor(setup);
+        setup.stage_profiler = true;
+        auto processor_on = create_processor(setup);
+
+        juce::AudioBuffer<float> noise(setup.num_channels, setup.block_size);
+        juce::Random random(0x5E0);
+        fill_with_noise(noise, random);
+
+        auto num_blocks = juce::jmax(16, (int)(seconds * setup.sample_rate / setup.block_size / num_rounds));
+        measure_round(*processor_off, setup, noise, 16);
+        measure_round(*processor_on, setup, noise, 16);
+
+        auto fastest_off = std::numeric_limits<double>::max(), fastest_on = std::numeric_limits<double>::max();
+        for (int round = 0; round < num_rounds; ++round)
+        {
+            fastest_off = juce::jmin(fastest_off, measure_round(*processor_off, setup, noise, num_blocks));
+            fastest_on = juce::jmin(fastest_on, measure_round(*processor_on, setup, noise, num_blocks));
+        }
+
+        auto overhead = 100.0 * (fastest_on / fastest_off - 1.0);
+        within_bound = overhead <= max_overhead;
+
+        auto* cpu = new juce::DynamicObject();
+        cpu->setProperty("off", fastest_off);
+        cpu->setProperty("on", fastest_on);
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("block_size", setup.block_size);
+        result->setProperty("channels", setup.num_channels);
+        result->setProperty("active_bands", setup.num_active_bands);
+        result->setProperty("slope_db_per_oct", 12 * ((int)setup.cut_slope + 1));
+        result->setProperty("ns_per_sample", cpu);
+        result->setProperty("overhead_percent", overhead);
+        result->setProperty("within_bound", within_bound);
+        return result;
+    }
+}
+
+void run_profiler_overhead(const juce::ArgumentList& arguments)
+{
+    auto block_sizes = get_int_list(arguments, "--block-sizes", { 64, 512 });
+    auto channel_counts = get_int_list(arguments, "--channels", { 1, 2, 6 });
+    auto active_bands = get_int_list(arguments, "--active-bands", { 1, 8 });
+    auto max_overhead = get_double(arguments, "--max-overhead", 1.0);
+    auto num_rounds = juce::jmax(1, (int)get_double(arguments, "--rounds", 10.0));
+
+    ProcessorSetup setup;
+    setup.sample_rate = get_double(arguments, "--sample-rate", 48000.0);
+    setup.cut_slope = slope::slope_48;
+    auto seconds = get_double(arguments, "--seconds", 2.0);
+
+    juce::Array<juce::var> results;
+    int num_out_of_bound = 0;
+    for (auto num_bands_in_use : active_bands)
+        for (auto num_channels : channel_counts)
+            for (auto block_size : block_sizes)
+            {
+                setup.num_active_bands = num_bands_in_use;
+                setup.num_channels = num_channels;
+                setup.block_size = block_size;
+
+                auto within_bound = true;
+                results.add(run_configuration(setup, seconds, num_rounds, max_overhead, within_bound));
+                if (!within_bound)
+                    ++num_out_of_bound;
+            }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("benchmark", "profiler_overhead");
+    report->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("sample_rate", setup.sample_rate);
+    report->setProperty("max_overhead_percent", max_overhead);
+    report->setProperty("results", results);
+    write_json(arguments, report);
+
+    if (num_out_of_bound > 0)
+        juce::ConsoleApplication::fail(juce::String(num_out_of_bound) + " configurations where the stage profiler adds more than "
+                                       + juce::String(max_overhead) + "% to processBlock");
+}
@@ -0,0 +1,105 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Drives prepareToPlay / processBlock / setStateInformation under random
+    parameter automation and fails on any realtime-unsafe call made from
+    inside the audio callback, including the parameter listeners the
+    automation reaches. Needs a build with SEQ_REALTIME_CHECKS=1 (the
+    RealtimeCheck configuration).
+
+  ==============================================================================
+*/
+
+#include "Commands.h"
+#include "BenchmarkHelpers.h"
+
+static juce::var check_configuration(const ProcessorSetup& setup, int num_blocks, juce::Random& random)
+{
+    auto processor = create_processor(setup);
+
+    juce::MemoryBlock state;
+    processor->getStateInformation(state);
+
+    juce::AudioBuffer<float> buffer(setup.num_channels, setup.block_size);
+    juce::MidiBuffer midi;
+    auto& parameters = processor->getParameters();
+
+    RealtimeSafety::reset();
+
+    for (int block = 0; block < num_blocks; ++block)
+    {
+        // Message thread work between callbacks, like a host recalling a session
+        if (block % 64 == 32)
+            processor->setStateInformation(state.getData(), (int)state.getSize());
+        if (block % 256 == 255)
+            processor->prepareToPlay(setup.sample_rate, setup.block_size);
+
+        fill_with_noise(buffer, random);
+
+        RealtimeSafety::ScopedAudioCallback audio_callback;
+
+        // Hosts apply automation from the audio thread. The plugin wrappers set the value and
+        // then notify the parameter's listeners, which is what reaches the processor's own
+        // listeners and the raw values processBlock reads
+        if (block % 4 == 0)
+        {
+            auto* parameter = parameters.getUnchecked(random.nextInt(parameters.size()));
+            auto value = random.nextFloat();
+            parameter->setValue(value);
+
+            RealtimeSafety::ScopedHostListenerLock host_listener_lock;
+            parameter->sendValueChangedMessageToListeners(value);
+        }
+
+        processor->processBlock(buffer, midi);
+    }
+
+    auto* result = new juce::DynamicObject();
+    result->setProperty("sample_rate", setup.sample_rate);
+    result->setProperty("block_size", setup.block_size);
+    result->setProperty("channels", setup.num_channels);
+    result->setProperty("allocations", RealtimeSafety::get_num_violations(RealtimeSafety::violation::allocation));
+    result->setProperty("deallocations", RealtimeSafety::get_num_violations(RealtimeSafety::violation::deallocation));
+    result->setProperty("locks", RealtimeSafety::get_num_violations(RealtimeSafety::violation::lock));
+    result->setProperty("violations", RealtimeSafety::get_violation_reports());
+    return result;
+}
+
+void run_realtime_check(const juce::ArgumentList& arguments)
+{
+    if (!RealtimeSafety::is_enabled())
+        juce::ConsoleApplication::fail("--realtime-check needs a build with SEQ_REALTIME_CHECKS=1 (the RealtimeCheck configuration)");
+
+    auto sample_rates = get_int_list(arguments, "--sample-rates", { 44100, 96000 });
+    auto block_sizes = get_int_list(arguments, "--block-sizes", { 32, 512 });
+    auto channel_counts = get_int_list(arguments, "--channels", { 1, 2, 8 });
+    auto num_blocks = (int)get_double(arguments, "--blocks", 2000);
+
+    juce::Random random(0x5E0);
+    juce::Array<juce::var> results;
+    int total_violations = 0;
+
+    for (auto sample_rate : sample_rates)
+        for (auto block_size : block_sizes)
+            for (auto num_channels : channel_counts)
+                for (int slope_index = 0; slope_index < 4; ++slope_index)
+                {
+                    ProcessorSetup setup;
+                    setup.sample_rate = sample_rate;
+                    setup.block_size = block_size;
+                    setup.num_channels = num_channels;
+                    setup.cut_slope = static_cast<slope>(slope_index);
+                    results.add(check_configuration(setup, num_blocks, random));
+                    total_violations += RealtimeSafety::get_total_violations();
+                }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("benchmark", "realtime_check");
+    report->setProperty("total_violations", total_violations);
+    report->setProperty("results", results);
+    write_json(arguments, report);
+
+    if (total_violations > 0)
+        juce::ConsoleApplication::fail(juce::String(total_violations) + " realtime-unsafe calls inside processBlock");
+}
@@ -0,0 +1,239 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    The SIMD band engine against the scalar chain it replaced.
+
+    The scalar side is the chain SEQ ran before SIMDFilterChain: one
+    juce::dsp::ProcessorChain of IIR::Filters per channel, the cuts from
+    FilterDesign's Butterworth methods and the bands from makePeakFilter,
+    designed in the precision being processed. The SIMD side designs its
+    own sections in double, so the two are not expected to match bit for
+    bit: in float most of the difference is the 20 Hz low cut designed in
+    float on the scalar side. The command reports the difference relative
+    to the scalar output, in dB, and fails if it's above --float-tolerance
+    (-50 dB) or --double-tolerance (-200 dB).
+
+  ==============================================================================
+*/
+
+#include "Commands.h"
+#include "BenchmarkHelpers.h"
+
+namespace
+{
+    template <typename SampleType>
+    class ScalarChain
+    {
+    public:
+        ScalarChain(const ChainSettings& chain_settings, const ProcessorSetup& setup)
+            : chains((size_t)setup.num_channels)
+        {
+            using FilterDesign = juce::dsp::FilterDesign<SampleType>;
+            auto low_cut = FilterDesign::designIIRHighpassHighOrderButterworthMethod((SampleType)chain_settings.low_cut_freq, setup.sample_rate,
+                                                                                    2 * get_num_cut_sections(chain_settings.low_cut_slope));
+            auto high_cut = FilterDesign::designIIRLowpassHighOrderButterworthMethod((SampleType)chain_settings.high_cut_freq, setup.sample_rate,
+                                                                                    2 * get_num_cut_sections(chain_settings.high_cut_slope));
+
+            juce::ReferenceCountedArray<Coefficients> bands;
+            for (auto& band : chain_settings.bands)
+                if (band.is_active())
+                    bands.add(Coefficients::makePeakFilter(setup.sample_rate, (SampleType)band.freq, (SampleType)band.quality,
+                                                           juce::Decibels::decibelsToGain((SampleType)band.gain_in_decibels)));
+
+            for (auto& chain : chains)
+            {
+                set_filters(chain.template get<0>(), low_cut, std::make_index_sequence<4>());
+                set_filters(chain.template get<1>(), bands, std::make_index_sequence<num_bands>());
+                set_filters(chain.template get<2>(), high_cut, std::make_index_sequence<4>());
+                chain.prepare({ setup.sample_rate, (juce::uint32)setup.block_size, 1 });
+            }
+        }
+
+        void process(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+        {
+            for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+            {
+                auto channel_block = block.getSingleChannelBlock(channel);
+                chains[channel].process(juce::dsp::ProcessContextReplacing<SampleType>(channel_block));
+            }
+        }
+
+    private:
+        using Coefficients = juce::dsp::IIR::Coefficients<SampleType>;
+        using Filter = juce::dsp::IIR::Filter<SampleType>;
+        using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+        using BandFilters = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter, Filter, Filter, Filter, Filter>;
+        using MonoChain = juce::dsp::ProcessorChain<CutFilter, BandFilters, CutFilter>;
+        static_assert(num_bands == 8);
+
+        // Like the original chain, the filters past the designed ones are bypassed
+        template <size_t index, typename Chain>
+        static void set_filter(Chain& chain, const juce::ReferenceCountedArray<Coefficients>& coefficients)
+        {
+            chain.template setBypassed<index>((int)index >= coefficients.size());
+            if ((int)index < coefficients.size())
+                chain.template get<index>().coefficients = coefficients[(int)index];
+        }
+
+        template <typename Chain, size_t... indices>
+        static void set_filters(Chain& chain, const juce::ReferenceCountedArray<Coefficients>& coefficients, std::index_sequence<indices...>)
+        {
+            (set_filter<indices>(chain, coefficients), ...);
+        }
+
+        std::vector<MonoChain> chains;
+    };
+
+    // Runs the whole input block by block through chain, the first few blocks aren't timed
+    template <typename SampleType, typename Chain>
+    double run_chain(Chain& chain, const ProcessorSetup& setup, const juce::AudioBuffer<SampleType>& input, juce::AudioBuffer<SampleType>& output)
+    {
+        juce::AudioBuffer<SampleType> buffer(setup.num_channels, setup.block_size);
+        static constexpr int num_warm_up_blocks = 16;
+        juce::int64 ticks = 0;
+        int num_timed_samples = 0;
+        for (int block = 0; (block + 1) * setup.block_size <= input.getNumSamples(); ++block)
+        {
+            auto position = block * setup.block_size;
+            for (int channel = 0; channel < setup.num_channels; ++channel)
+                buffer.copyFrom(channel, 0, input, channel, position, setup.block_size);
+
+            auto start = juce::Time::getHighResolutionTicks();
+            chain.process(juce::dsp::AudioBlock<SampleType>(buffer));
+            auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+            if (block >= num_warm_up_blocks)
+            {
+                ticks += elapsed;
+                num_timed_samples += setup.block_size;
+            }
+
+            for (int channel = 0; channel < setup.num_channels; ++channel)
+                output.copyFrom(channel, position, buffer, channel, 0, setup.block_size);
+        }
+
+        return ticks_to_nanoseconds(ticks) / juce::jmax(1.0, (double)num_timed_samples * setup.num_channels);
+    }
+
+    // Level of the difference relative to the reference, in dB
+    template <typename SampleType>
+    double get_error_in_decibels(const juce::AudioBuffer<SampleType>& output, const juce::AudioBuffer<SampleType>& reference)
+    {
+        auto error_energy = 0.0, reference_energy = 0.0;
+        for (int channel = 0; channel < reference.getNumChannels(); ++channel)
+        {
+            for (int i = 0; i < reference.getNumSamples(); ++i)
+            {
+                auto difference = (double)output.getSample(channel, i) - (double)reference.getSample(channel, i);
+                error_energy += difference * difference;
+                reference_energy += (double)reference.getSample(channel, i) * (double)reference.getSample(channel, i);
+            }
+        }
+
+        return 10.0 * std::log10(juce::jmax(error_energy, 1.0e-300) / juce::jmax(reference_energy, 1.0e-300));
+    }
+
+    template <typename SampleType>
+    juce::var run_configuration(const ChainSettings& chain_settings, const ProcessorSetup& setup, double seconds, double tolerance, bool& within_tolerance)
+    {
+        auto num_samples = juce::jmax(64, (int)(seconds * setup.sample_rate / setup.block_size)) * setup.block_size;
+        juce::AudioBuffer<SampleType> input(setup.num_channels, num_samples), scalar_output(setup.num_channels, num_samples), simd_output(setup.num_channels, num_samples);
+        juce::Random random(0x5E0);
+        for (int channel = 0; channel < setup.num_channels; ++channel)
+            for (int i = 0; i < num_samples; ++i)
+                input.setSample(channel, i, (SampleType)(random.nextDouble() * 2.0 - 1.0));
+
+        ScalarChain<SampleType> scalar_chain(chain_settings, setup);
+        auto scalar_ns = run_chain(scalar_chain, setup, input, scalar_output);
+
+        // Interleaved for mono too, the time blocked kernel is --lane-layout's business
+        auto coefficient_set = design_coefficients(chain_settings, setup.sample_rate);
+        SIMDFilterChain<SampleType> simd_chain;
+        simd_chain.set_lane_layout(SIMDFilterChain<SampleType>::lane_layout::interleaved);
+        simd_chain.prepare({ setup.sample_rate, (juce::uint32)setup.block_size, (juce::uint32)setup.num_channels });
+        simd_chain.update(coefficient_set);
+        auto simd_ns = run_chain(simd_chain, setup, input, simd_output);
+
+        auto max_difference = 0.0;
+        for (int channel = 0; channel < setup.num_channels; ++channel)
+            for (int i = 0; i < num_samples; ++i)
+                max_difference = juce::jmax(max_difference, std::abs((double)simd_output.getSample(channel, i) - (double)scalar_output.getSample(channel, i)));
+        auto error_in_decibels = get_error_in_decibels(simd_output, scalar_output);
+        within_tolerance = error_in_decibels <= tolerance;
+
+        auto* cpu = new juce::DynamicObject();
+        cpu->setProperty("scalar", scalar_ns);
+        cpu->setProperty("simd", simd_ns);
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("precision", std::is_same_v<SampleType, double> ? "double" : "float");
+        result->setProperty("lanes", (int)SIMDFilterChain<SampleType>::get_num_lanes());
+        result->setProperty("channels", setup.num_channels);
+        result->setProperty("sections", coefficient_set.num_sections);
+        result->setProperty("ns_per_sample", cpu);
+        result->setProperty("speedup", scalar_ns / juce::jmax(simd_ns, 1.0e-9));
+        result->setProperty("error_db", error_in_decibels);
+        result->setProperty("max_abs_difference", max_difference);
+        result->setProperty("within_tolerance", within_tolerance);
+        return result;
+    }
+}
+
+void run_scalar_comparison(const juce::ArgumentList& arguments)
+{
+    auto channel_counts = get_int_list(arguments, "--channels", { 1, 2, 6, 16 });
+    auto active_bands = get_int_list(arguments, "--active-bands", { 1, 8 });
+    auto float_tolerance = get_double(arguments, "--float-tolerance", -50.0);
+    auto double_tolerance = get_double(arguments, "--double-tolerance", -200.0);
+
+    ProcessorSetup setup;
+    setup.sample_rate = get_double(arguments, "--sample-rate", 48000.0);
+    setup.block_size = (int)get_double(arguments, "--block-size", 512.0);
+    auto seconds = get_double(arguments, "--seconds", 1.0);
+
+    juce::Array<juce::var> results;
+    int num_mismatches = 0;
+    for (auto num_bands_in_use : active_bands)
+    {
+        // Both cuts at 48 dB/Oct and the bands spread over the spectrum, every section type runs
+        ChainSettings chain_settings;
+        chain_settings.low_cut_freq = 20.f;
+        chain_settings.high_cut_freq = 18000.f;
+        chain_settings.low_cut_slope = chain_settings.high_cut_slope = slope::slope_48;
+        for (int band = 0; band < juce::jlimit(0, num_bands, num_bands_in_use); ++band)
+        {
+            chain_settings.bands[(size_t)band].freq = 60.f * std::pow(2.f, (float)band);
+            chain_settings.bands[(size_t)band].gain_in_decibels = 6.f;
+        }
+
+        for (auto num_channels : channel_counts)
+        {
+            setup.num_channels = juce::jlimit(1, SIMDFilterChain<float>::max_channels, num_channels);
+
+            auto within_tolerance = true;
+            results.add(run_configuration<float>(chain_settings, setup, seconds, float_tolerance, within_tolerance));
+            num_mismatches += within_tolerance ? 0 : 1;
+
+            results.add(run_configuration<double>(chain_settings, setup, seconds, double_tolerance, within_tolerance));
+            num_mismatches += within_tolerance ? 0 : 1;
+        }
+    }
+
+    auto* tolerance = new juce::DynamicObject();
+    tolerance->setProperty("float", float_tolerance);
+    tolerance->setProperty("double", double_tolerance);
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("benchmark", "scalar_comparison");
+    report->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("sample_rate", setup.sample_rate);
+    report->setProperty("block_size", setup.block_size);
+    report->setProperty("tolerance_db", tolerance);
+    report->setProperty("results", results);
+    write_json(arguments, report);
+
+    if (num_mismatches > 0)
+        juce::ConsoleApplication::fail(juce::String(num_mismatches) + " configurations where the SIMD chain differs from the scalar chain by more than the tolerance");
+}
@@ -0,0 +1,150 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    What opening a session costs per instance.
+
+    Every instance is built the way a host opens a project: construct,
+    restore the saved state, prepare and run the first block, in both of
+    the orders hosts use. The state is saved once in the binary format and
+    once as the ValueTree older builds wrote, with every band in use and
+    the snapshots all different, and restored into --instances processors
+    that stay alive until the run ends, like the instances in a session.
+
+  ==============================================================================
+*/
+
+#include "Commands.h"
+#include "BenchmarkHelpers.h"
+
+namespace
+{
+    struct Timings
+    {
+        double construct{ 0.0 }, restore{ 0.0 }, prepare{ 0.0 }, first_block{ 0.0 }, second_block{ 0.0 };
+    };
+
+    // A state with something for every part of the restore to do
+    void make_states(const ProcessorSetup& setup, juce::MemoryBlock& binary_state, juce::MemoryBlock& value_tree_state)
+    {
+        auto processor = create_processor(setup);
+        for (int i = 0; i < SnapshotBank::num_snapshots; ++i)
+        {
+            set_parameter(*processor, LOW_CUT_FREQ, 30.f + 10.f * (float)i);
+            set_parameter(*processor, HIGH_CUT_FREQ, 18000.f - 1000.f * (float)i);
+            set_parameter(*processor, PEAK_GAIN, -6.f + 1.5f * (float)i);
+            processor->store_snapshot(i);
+        }
+        processor->setCurrentProgram(2);
+
+        processor->getStateInformation(binary_state);
+        processor->write_value_tree_state(value_tree_state);
+    }
+
+    juce::var measure(const ProcessorSetup& setup, const juce::MemoryBlock& state, bool restore_first, int num_instances)
+    {
+        juce::AudioBuffer<float> noise(setup.num_channels, setup.block_size), buffer(setup.num_channels, setup.block_size);
+        juce::Random random(0x5E0);
+        fill_with_noise(noise, random);
+        juce::MidiBuffer midi;
+
+        std::vector<std::unique_ptr<SEQAudioProcessor>> instances;
+        Timings total;
+        auto elapsed_microseconds = [](juce::int64& start)
+        {
+            auto now = juce::Time::getHighResolutionTicks();
+            auto microseconds = juce::Time::highResolutionTicksToSeconds(now - start) * 1.0e6;
+            start = now;
+            return microseconds;
+        };
+
+        for (int i = 0; i < num_instances; ++i)
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+            auto processor = std::make_unique<SEQAudioProcessor>();
+            juce::AudioProcessor::BusesLayout layout;
+            layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(setup.num_channels));
+            layout.inputBuses.add(juce::AudioChannelSet::disabled());
+            layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(setup.num_channels));
+            processor->setBusesLayout(layout);
+            total.construct += elapsed_microseconds(start);
+
+            auto restore = [&] { processor->setStateInformation(state.getData(), (int)state.getSize()); total.restore += elapsed_microseconds(start); };
+            auto prepare = [&]
+            {
+                processor->setRateAndBufferSizeDetails(setup.sample_rate, setup.block_size);
+                processor->prepareToPlay(setup.sample_rate, setup.block_size);
+                total.prepare += elapsed_microseconds(start);
+            };
+
+            if (restore_first)
+            {
+                restore();
+                prepare();
+            }
+            else
+            {
+                prepare();
+                restore();
+            }
+
+            buffer.makeCopyOf(noise, true);
+            processor->processBlock(buffer, midi);
+            total.first_block += elapsed_microseconds(start);
+
+            buffer.makeCopyOf(noise, true);
+            processor->processBlock(buffer, midi);
+            total.second_block += elapsed_microseconds(start);
+
+            instances.push_back(std::move(processor));
+        }
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("order", restore_first ? "restore, prepare" : "prepare, restore");
+        result->setProperty("construct_us", total.construct / num_instances);
+        result->setProperty("restore_us", total.restore / num_instances);
+        result->setProperty("prepare_us", total.prepare / num_instances);
+        result->setProperty("first_block_us", total.first_block / num_instances);
+        result->setProperty("second_block_us", total.second_block / num_instances);
+        result->setProperty("session_ms", (total.construct + total.restore + total.prepare + total.first_block) / 1000.0);
+        return result;
+    }
+}
+
+void run_state_recall(const juce::ArgumentList& arguments)
+{
+    ProcessorSetup setup;
+    setup.sample_rate = get_double(arguments, "--sample-rate", 48000.0);
+    setup.block_size = (int)get_double(arguments, "--block-size", 512.0);
+    setup.num_channels = (int)get_double(arguments, "--channels", 2.0);
+    setup.num_active_bands = num_bands;
+    setup.cut_slope = slope::slope_48;
+    auto num_instances = juce::jmax(1, (int)get_double(arguments, "--instances", 300.0));
+
+    juce::MemoryBlock binary_state, value_tree_state;
+    make_states(setup, binary_state, value_tree_state);
+
+    juce::Array<juce::var> results;
+    for (auto* format : { "binary", "value_tree" })
+    {
+        auto& state = juce::String(format) == "binary" ? binary_state : value_tree_state;
+        for (auto restore_first : { true, false })
+        {
+            auto result = measure(setup, state, restore_first, num_instances);
+            result.getDynamicObject()->setProperty("format", format);
+            result.getDynamicObject()->setProperty("state_bytes", (int)state.getSize());
+            results.add(result);
+        }
+    }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("benchmark", "state_recall");
+    report->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("sample_rate", setup.sample_rate);
+    report->setProperty("block_size", setup.block_size);
+    report->setProperty("channels", setup.num_channels);
+    report->setProperty("instances", num_instances);
+    report->setProperty("results", results);
+    write_json(arguments, report);
+}
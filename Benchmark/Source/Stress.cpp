@@ -0,0 +1,318 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Worst case block times while automation moves.
+
+    Automation lanes, recorded or generated, are replayed into the processor
+    the way a host does it: setValue from the audio thread before each
+    block. Only processBlock is timed, one measurement per block, so the
+    report shows the spikes that averages hide. Every run is repeated with
+    the measuring thread pinned to one core and with threads streaming
+    through memory in the background, which is closer to a busy session
+    than an idle machine.
+
+    Lanes are JSON, breakpoints in seconds and real parameter units with
+    straight lines in between, and two breakpoints at the same time make a
+    jump:
+        { "lanes": { "LowCut Freq": [[0.0, 20], [1.5, 400], [1.5, 80]], ... } }
+
+  ==============================================================================
+*/
+
+#include "Commands.h"
+#include "BenchmarkHelpers.h"
+#include <map>
+#include <numeric>
+
+namespace
+{
+    // The original seven parameters, the ones sessions automate most
+    const char* const automated_parameters[] = { LOW_CUT_FREQ, HIGH_CUT_FREQ, PEAK_FREQ, PEAK_GAIN, PEAK_QUALITY, LOW_CUT_SLOPE, HIGH_CUT_SLOPE };
+
+    struct AutomationLane
+    {
+        juce::String parameter_id;
+        std::vector<std::pair<double, float>> points;
+
+        float get_value(double time) const noexcept
+        {
+            auto next = std::upper_bound(points.begin(), points.end(), time, [](double t, const std::pair<double, float>& point) { return t < point.first; });
+            if (next == points.begin())
+                return next->second;
+            if (next == points.end())
+                return points.back().second;
+
+            auto previous = std::prev(next);
+            auto position = (float)((time - previous->first) / (next->first - previous->first));
+            return previous->second + position * (next->second - previous->second);
+        }
+    };
+
+    // A new target every 20 to 500 ms, reached with a ramp or a jump. Choices always jump
+    std::vector<AutomationLane> generate_lanes(SEQAudioProcessor& processor, double seconds, juce::Random& random)
+    {
+        std::vector<AutomationLane> lanes;
+        for (auto* parameter_id : automated_parameters)
+        {
+            auto* parameter = processor.audio_processor_value_tree_state.getParameter(parameter_id);
+            AutomationLane lane{ parameter_id, {} };
+
+            auto time = 0.0;
+            auto value = parameter->convertFrom0to1(random.nextFloat());
+            lane.points.push_back({ time, value });
+            while (time < seconds)
+            {
+                time += 0.02 + 0.48 * random.nextDouble();
+                auto next_value = parameter->convertFrom0to1(random.nextFloat());
+                if (parameter->isDiscrete() || random.nextInt(4) == 0)
+                    lane.points.push_back({ time, value });
+                lane.points.push_back({ time, next_value });
+                value = next_value;
+            }
+            lanes.push_back(std::move(lane));
+        }
+        return lanes;
+    }
+
+    std::vector<AutomationLane> load_lanes(SEQAudioProcessor& processor, const juce::File& file)
+    {
+        auto* lanes_object = juce::JSON::parse(file).getProperty("lanes", {}).getDynamicObject();
+        if (lanes_object == nullptr)
+            juce::ConsoleApplication::fail("No \"lanes\" object in " + file.getFullPathName());
+
+        std::vector<AutomationLane> lanes;
+        for (auto& property : lanes_object->getProperties())
+        {
+            auto parameter_id = property.name.toString();
+            if (processor.audio_processor_value_tree_state.getParameter(parameter_id) == nullptr)
+                juce::ConsoleApplication::fail("Unknown parameter in " + file.getFullPathName() + ": " + parameter_id);
+
+            AutomationLane lane{ parameter_id, {} };
+            if (auto* points = property.value.getArray())
+                for (auto& point : *points)
+                    lane.points.push_back({ (double)point[0], (float)point[1] });
+
+            std::stable_sort(lane.points.begin(), lane.points.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+            if (!lane.points.empty())
+                lanes.push_back(std::move(lane));
+        }
+        return lanes;
+    }
+
+    void save_lanes(const std::vector<AutomationLane>& lanes, const juce::File& file)
+    {
+        auto* lanes_object = new juce::DynamicObject();
+        for (auto& lane : lanes)
+        {
+            juce::Array<juce::var> points;
+            for (auto& point : lane.points)
+                points.add(juce::Array<juce::var>{ point.first, point.second });
+            lanes_object->setProperty(lane.parameter_id, points);
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty("lanes", lanes_object);
+        if (!file.replaceWithText(juce::JSON::toString(root)))
+            juce::ConsoleApplication::fail("Couldn't write " + file.getFullPathName());
+    }
+
+    // Streams through a buffer bigger than the last level cache, so the processor
+    // has to compete for cache and memory bandwidth as well as for cores
+    class LoadThread : public juce::Thread
+    {
+    public:
+        explicit LoadThread(int index)
+            : juce::Thread("SEQ Stress Load " + juce::String(index + 1)), data((size_t)4 << 20, 1.f)
+        {
+        }
+
+        void run() override
+        {
+            auto sum = 0.f;
+            while (!threadShouldExit())
+                for (size_t i = 0; i < data.size(); i += 16)
+                {
+                    data[i] = data[i] * 0.5f + 1.f;
+                    sum += data[i];
+                }
+            result = sum;
+        }
+
+    private:
+        std::vector<float> data;
+        std::atomic<float> result{ 0.f };
+    };
+
+    class MeasurementThread : public juce::Thread
+    {
+    public:
+        MeasurementThread(int core, std::function<void()> body)
+            : juce::Thread("SEQ Stress"), pin_core(core), measure(std::move(body))
+        {
+        }
+
+        void run() override
+        {
+            if (pin_core >= 0)
+                juce::Thread::setCurrentThreadAffinityMask((juce::uint32)1 << pin_core);
+            measure();
+        }
+
+    private:
+        const int pin_core;
+        std::function<void()> measure;
+    };
+
+    std::vector<juce::int64> measure_blocks(const ProcessorSetup& setup, const std::vector<AutomationLane>& lanes, double seconds)
+    {
+        auto processor = create_processor(setup);
+
+        std::vector<juce::RangedAudioParameter*> parameters;
+        for (auto& lane : lanes)
+            parameters.push_back(processor->audio_processor_value_tree_state.getParameter(lane.parameter_id));
+        std::vector<float> last_values(lanes.size(), std::numeric_limits<float>::quiet_NaN());
+
+        juce::AudioBuffer<float> noise(setup.num_channels, setup.block_size), buffer(setup.num_channels, setup.block_size);
+        juce::Random random(0x5E0);
+        fill_with_noise(noise, random);
+        juce::MidiBuffer midi;
+
+        auto num_blocks = juce::jmax(1, (int)(seconds * setup.sample_rate / setup.block_size));
+        std::vector<juce::int64> block_ticks((size_t)num_blocks);
+
+        // Hosts only send a value when it changes, and the first few blocks settle the caches
+        auto process_block = [&](int block)
+        {
+            auto time = (double)juce::jmax(0, block) * setup.block_size / setup.sample_rate;
+            for (size_t i = 0; i < lanes.size(); ++i)
+            {
+                auto value = lanes[i].get_value(time);
+                if (value != last_values[i])
+                {
+                    parameters[i]->setValue(parameters[i]->convertTo0to1(value));
+                    last_values[i] = value;
+                }
+            }
+
+            buffer.makeCopyOf(noise, true);
+            auto start = juce::Time::getHighResolutionTicks();
+            processor->processBlock(buffer, midi);
+            return juce::Time::getHighResolutionTicks() - start;
+        };
+
+        for (int block = -16; block < 0; ++block)
+            process_block(block);
+        for (int block = 0; block < num_blocks; ++block)
+            block_ticks[(size_t)block] = process_block(block);
+
+        processor->releaseResources();
+        return block_ticks;
+    }
+
+    juce::var summarise(const std::vector<juce::int64>& block_ticks, const ProcessorSetup& setup, double deadline_fraction)
+    {
+        std::vector<double> microseconds;
+        for (auto ticks : block_ticks)
+            microseconds.push_back(juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6);
+
+        auto worst_block = std::max_element(microseconds.begin(), microseconds.end()) - microseconds.begin();
+        auto deadline = deadline_fraction * setup.block_size / setup.sample_rate * 1.0e6;
+        auto misses = std::count_if(microseconds.begin(), microseconds.end(), [deadline](double time) { return time > deadline; });
+        auto mean = std::accumulate(microseconds.begin(), microseconds.end(), 0.0) / (double)microseconds.size();
+
+        auto sorted = microseconds;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](double fraction) { return sorted[(size_t)juce::jmax(0.0, std::ceil(fraction * (double)sorted.size()) - 1.0)]; };
+
+        // Octave buckets from 1 us, only the ones that aren't empty
+        std::map<int, int> buckets;
+        for (auto time : microseconds)
+            ++buckets[time < 1.0 ? 0 : (int)std::floor(std::log2(time)) + 1];
+
+        juce::Array<juce::var> histogram;
+        for (auto& bucket : buckets)
+        {
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("from_us", bucket.first == 0 ? 0.0 : std::exp2(bucket.first - 1));
+            entry->setProperty("to_us", std::exp2(bucket.first));
+            entry->setProperty("blocks", bucket.second);
+            histogram.add(entry);
+        }
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("blocks", (int)microseconds.size());
+        result->setProperty("mean_us", mean);
+        result->setProperty("p50_us", percentile(0.5));
+        result->setProperty("p99_us", percentile(0.99));
+        result->setProperty("p99_9_us", percentile(0.999));
+        result->setProperty("max_us", sorted.back());
+        result->setProperty("worst_block_seconds", (double)worst_block * setup.block_size / setup.sample_rate);
+        result->setProperty("deadline_us", deadline);
+        result->setProperty("deadline_misses", (int)misses);
+        result->setProperty("histogram", histogram);
+        return result;
+    }
+}
+
+void run_stress(const juce::ArgumentList& arguments)
+{
+    ProcessorSetup setup;
+    setup.sample_rate = get_double(arguments, "--sample-rate", 48000.0);
+    setup.block_size = (int)get_double(arguments, "--block-size", 128.0);
+    setup.num_channels = (int)get_double(arguments, "--channels", 2.0);
+    auto seconds = get_double(arguments, "--seconds", 10.0);
+    auto deadline_fraction = get_double(arguments, "--deadline", 0.5);
+    auto num_load_threads = (int)get_double(arguments, "--load-threads", (double)juce::jmax(1, juce::SystemStats::getNumCpus() - 1));
+    auto pin_core = (int)get_double(arguments, "--pin-core", 0.0);
+
+    std::vector<AutomationLane> lanes;
+    {
+        auto processor = create_processor(setup);
+        juce::Random random((juce::int64)get_double(arguments, "--seed", (double)0x5E0));
+        lanes = arguments.containsOption("--automation") ? load_lanes(*processor, arguments.getExistingFileForOption("--automation"))
+                                                         : generate_lanes(*processor, seconds, random);
+    }
+
+    if (arguments.containsOption("--save-automation"))
+        save_lanes(lanes, arguments.getFileForOption("--save-automation"));
+
+    juce::Array<juce::var> results;
+    for (auto pinned : { false, true })
+        for (auto loaded : { false, true })
+        {
+            juce::OwnedArray<LoadThread> load_threads;
+            if (loaded)
+                for (int i = 0; i < num_load_threads; ++i)
+                    load_threads.add(new LoadThread(i))->startThread();
+
+            std::vector<juce::int64> block_ticks;
+            MeasurementThread measurement(pinned ? pin_core : -1, [&] { block_ticks = measure_blocks(setup, lanes, seconds); });
+            measurement.startThread(juce::Thread::Priority::highest);
+            measurement.waitForThreadToExit(-1);
+
+            for (auto* load_thread : load_threads)
+                load_thread->stopThread(1000);
+
+            auto result = summarise(block_ticks, setup, deadline_fraction);
+            result.getDynamicObject()->setProperty("pinned", pinned);
+            result.getDynamicObject()->setProperty("load_threads", loaded ? num_load_threads : 0);
+            results.add(result);
+        }
+
+    juce::StringArray lane_names;
+    for (auto& lane : lanes)
+        lane_names.add(lane.parameter_id);
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("benchmark", "stress");
+    report->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("sample_rate", setup.sample_rate);
+    report->setProperty("block_size", setup.block_size);
+    report->setProperty("channels", setup.num_channels);
+    report->setProperty("deadline_fraction", deadline_fraction);
+    report->setProperty("automated_parameters", lane_names);
+    report->setProperty("results", results);
+    write_json(arguments, report);
+}
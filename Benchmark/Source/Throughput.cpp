@@ -0,0 +1,147 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Throughput sweep over sample rate, block size, channel count, slope and
+    the number of active bands.
+
+    With --automation, band 1's frequency and gain move every block, so the
+    smoother is always ramping, and the sweep also covers the control rate
+    the ramps are redesigned at. Control rate 0 is the no ramp case, where
+    every block snaps straight to the new coefficients.
+
+  ==============================================================================
+*/
+
+#include "Commands.h"
+#include "BenchmarkHelpers.h"
+#include "PerfCounters.h"
+
+static juce::var run_configuration(const ProcessorSetup& setup, double seconds, bool silent_input, bool automation)
+{
+    auto processor = create_processor(setup);
+
+    // A slow sweep of band 1 set like a host would, before the block and outside the timing
+    auto* band_freq = processor->audio_processor_value_tree_state.getParameter(get_band_parameter_id(0, BAND_FREQ));
+    auto* band_gain = processor->audio_processor_value_tree_state.getParameter(get_band_parameter_id(0, BAND_GAIN));
+    int block_index = 0;
+    auto automate = [&]
+    {
+        if (!automation)
+            return;
+
+        auto phase = juce::MathConstants<double>::twoPi * 0.5 * (double)block_index++ * setup.block_size / setup.sample_rate;
+        band_freq->setValue(band_freq->convertTo0to1((float)(1000.0 * std::exp2(2.0 * std::sin(phase)))));
+        band_gain->setValue(band_gain->convertTo0to1((float)(6.0 + 6.0 * std::cos(phase))));
+    };
+
+    juce::AudioBuffer<float> noise(setup.num_channels, setup.block_size), buffer(setup.num_channels, setup.block_size);
+    juce::Random random(0x5E0);
+    fill_with_noise(noise, random);
+    if (silent_input)
+        noise.clear();
+    juce::MidiBuffer midi;
+
+    auto num_blocks = juce::jmax(1, (int)(seconds * setup.sample_rate / setup.block_size));
+
+    // Warm up caches and branch predictors before measuring
+    for (int i = 0; i < 16; ++i)
+    {
+        automate();
+        buffer.makeCopyOf(noise, true);
+        processor->processBlock(buffer, midi);
+    }
+
+    juce::int64 ticks = 0;
+    for (int i = 0; i < num_blocks; ++i)
+    {
+        automate();
+        buffer.makeCopyOf(noise, true);
+        auto start = juce::Time::getHighResolutionTicks();
+        processor->processBlock(buffer, midi);
+        ticks += juce::Time::getHighResolutionTicks() - start;
+    }
+
+    // Counted in a separate pass so the syscalls don't land in the timing
+    juce::var instructions_per_sample;
+    InstructionCounter counter;
+    if (counter.is_available())
+    {
+        juce::uint64 instructions = 0;
+        for (int i = 0; i < num_blocks; ++i)
+        {
+            automate();
+            buffer.makeCopyOf(noise, true);
+            counter.start();
+            processor->processBlock(buffer, midi);
+            instructions += counter.stop();
+        }
+        instructions_per_sample = (double)instructions / ((double)num_blocks * setup.block_size * setup.num_channels);
+    }
+
+    processor->releaseResources();
+
+    auto num_samples = (double)num_blocks * setup.block_size * setup.num_channels;
+    auto seconds_elapsed = juce::Time::highResolutionTicksToSeconds(ticks);
+
+    auto* result = new juce::DynamicObject();
+    result->setProperty("sample_rate", setup.sample_rate);
+    result->setProperty("block_size", setup.block_size);
+    result->setProperty("channels", setup.num_channels);
+    result->setProperty("slope_db_per_oct", 12 * ((int)setup.cut_slope + 1));
+    result->setProperty("active_bands", setup.num_active_bands);
+    result->setProperty("input", silent_input ? "silence" : "noise");
+    result->setProperty("dynamic_band", setup.dynamic_band);
+    result->setProperty("stage_profiler", setup.stage_profiler);
+    result->setProperty("automation", automation);
+    result->setProperty("control_rate", setup.control_rate >= 0 ? juce::var(setup.control_rate) : juce::var("parameter"));
+    result->setProperty("ns_per_sample", ticks_to_nanoseconds(ticks) / num_samples);
+    result->setProperty("samples_per_second", num_samples / seconds_elapsed);
+    result->setProperty("realtime_factor", (double)num_blocks * setup.block_size / setup.sample_rate / seconds_elapsed);
+    result->setProperty("instructions_per_sample", instructions_per_sample);
+    return result;
+}
+
+void run_throughput(const juce::ArgumentList& arguments)
+{
+    auto sample_rates = get_int_list(arguments, "--sample-rates", { 44100, 48000, 88200, 96000, 176400, 192000 });
+    auto block_sizes = get_int_list(arguments, "--block-sizes", { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 });
+    auto channel_counts = get_int_list(arguments, "--channels", { 1, 2, 6, 12, 16 });
+    auto slopes = get_int_list(arguments, "--slopes", { 12, 24, 36, 48 });
+    auto active_band_counts = get_int_list(arguments, "--active-bands", { 1 });
+    auto seconds = get_double(arguments, "--seconds", 1.0);
+    auto silent_input = arguments.containsOption("--silence");
+    auto dynamic_band = arguments.containsOption("--dynamic");
+    auto stage_profiler = arguments.containsOption("--profile");
+    auto automation = arguments.containsOption("--automation");
+
+    // Only swept under automation, without it nothing ramps and the rate makes no difference
+    auto control_rates = automation ? get_int_list(arguments, "--control-rates", { 0, 1, 8, 32, 64 }) : juce::Array<int>{ -1 };
+
+    juce::Array<juce::var> results;
+    for (auto sample_rate : sample_rates)
+        for (auto block_size : block_sizes)
+            for (auto num_channels : channel_counts)
+                for (auto slope_db : slopes)
+                    for (auto num_active_bands : active_band_counts)
+                        for (auto control_rate : control_rates)
+                        {
+                            ProcessorSetup setup;
+                            setup.sample_rate = sample_rate;
+                            setup.block_size = block_size;
+                            setup.num_channels = num_channels;
+                            setup.cut_slope = static_cast<slope>(juce::jlimit(0, 3, slope_db / 12 - 1));
+                            setup.num_active_bands = num_active_bands;
+                            setup.dynamic_band = dynamic_band;
+                            setup.stage_profiler = stage_profiler;
+                            setup.control_rate = control_rate;
+                            results.add(run_configuration(setup, seconds, silent_input, automation));
+                        }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("benchmark", "throughput");
+    report->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("results", results);
+    write_json(arguments, report);
+}
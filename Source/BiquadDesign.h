@@ -0,0 +1,345 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Allocation free biquad design.
+
+    Same formulas as juce::dsp::IIR::Coefficients::makePeakFilter,
+    makeLowShelf, makeHighShelf, makeNotch and FilterDesign's
+    designIIRHighpassHighOrderButterworthMethod and
+    designIIRLowpassHighOrderButterworthMethod, but writing plain structs
+    instead of heap allocated coefficient objects. The Butterworth cascade
+    evaluates tan() once for all of its sections, and the per-section Q
+    values are constants, so this is cheap enough to run on the audio
+    thread at control rate.
+
+    Both cuts share one template on the number of sections. The slope is
+    turned into that number in a single switch, dispatch_cut_slope, and
+    everything after it is unrolled for the order, so a 12 dB/Oct cut is
+    one section with nothing to skip.
+
+    The matched versions follow M. Vicanek, "Matched Second Order Digital
+    Filters" (2016): the poles are mapped with the impulse invariant exp()
+    and the zeros are solved so the magnitude matches the analog prototype
+    at DC, Nyquist and the centre frequency. That removes most of the
+    bilinear cramping near Nyquist at the native rate. They are designed in
+    double because (1 + a1 + a2) cancels badly at low frequencies.
+
+    Every design is computed and stored in double. A 48 dB/Oct low cut at
+    20 Hz has poles within 0.003 of the unit circle, and rounding the
+    coefficients to float moves them noticeably, so the double chains keep
+    the full precision and the float chains round once when they load them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+
+struct BiquadCoefficients
+{
+    double b0{ 1.0 }, b1{ 0.0 }, b2{ 0.0 }, a1{ 0.0 }, a2{ 0.0 };
+};
+
+// The parts of make_peak_filter that only depend on frequency and Q. A band whose gain
+// moves on its own, like the dynamic band, keeps these and redesigns with a pow and two divisions
+struct PeakFilterTerms
+{
+    double alpha{ 0.0 }, c2{ -2.0 };
+
+    BiquadCoefficients make(float gain_in_decibels) const noexcept
+    {
+        auto A = juce::jmax(0.0, std::sqrt(juce::Decibels::decibelsToGain((double)gain_in_decibels)));
+        auto alpha_times_a = alpha * A;
+        auto alpha_over_a = alpha / A;
+        auto a0_inverse = 1 / (1 + alpha_over_a);
+
+        return { (1 + alpha_times_a) * a0_inverse, c2 * a0_inverse, (1 - alpha_times_a) * a0_inverse, c2 * a0_inverse, (1 - alpha_over_a) * a0_inverse };
+    }
+};
+
+inline PeakFilterTerms make_peak_filter_terms(double sample_rate, float frequency, float quality) noexcept
+{
+    auto omega = (2 * juce::MathConstants<double>::pi * juce::jmax(frequency, 2.f)) / sample_rate;
+    return { std::sin(omega) / (quality * 2.0), -2 * std::cos(omega) };
+}
+
+inline BiquadCoefficients make_peak_filter(double sample_rate, float frequency, float quality, float gain_in_decibels) noexcept
+{
+    return make_peak_filter_terms(sample_rate, frequency, quality).make(gain_in_decibels);
+}
+
+inline BiquadCoefficients make_low_shelf(double sample_rate, float frequency, float quality, float gain_in_decibels) noexcept
+{
+    auto A = juce::jmax(0.0, std::sqrt(juce::Decibels::decibelsToGain((double)gain_in_decibels)));
+    auto a_minus_1 = A - 1;
+    auto a_plus_1 = A + 1;
+    auto omega = (2 * juce::MathConstants<double>::pi * juce::jmax(frequency, 2.f)) / sample_rate;
+    auto cos_omega = std::cos(omega);
+    auto beta = std::sin(omega) * std::sqrt(A) / (double)quality;
+    auto a_minus_1_times_cos = a_minus_1 * cos_omega;
+    auto a0_inverse = 1 / (a_plus_1 + a_minus_1_times_cos + beta);
+
+    return { A * (a_plus_1 - a_minus_1_times_cos + beta) * a0_inverse,
+             A * 2 * (a_minus_1 - a_plus_1 * cos_omega) * a0_inverse,
+             A * (a_plus_1 - a_minus_1_times_cos - beta) * a0_inverse,
+             -2 * (a_minus_1 + a_plus_1 * cos_omega) * a0_inverse,
+             (a_plus_1 + a_minus_1_times_cos - beta) * a0_inverse };
+}
+
+inline BiquadCoefficients make_high_shelf(double sample_rate, float frequency, float quality, float gain_in_decibels) noexcept
+{
+    auto A = juce::jmax(0.0, std::sqrt(juce::Decibels::decibelsToGain((double)gain_in_decibels)));
+    auto a_minus_1 = A - 1;
+    auto a_plus_1 = A + 1;
+    auto omega = (2 * juce::MathConstants<double>::pi * juce::jmax(frequency, 2.f)) / sample_rate;
+    auto cos_omega = std::cos(omega);
+    auto beta = std::sin(omega) * std::sqrt(A) / (double)quality;
+    auto a_minus_1_times_cos = a_minus_1 * cos_omega;
+    auto a0_inverse = 1 / (a_plus_1 - a_minus_1_times_cos + beta);
+
+    return { A * (a_plus_1 + a_minus_1_times_cos + beta) * a0_inverse,
+             A * -2 * (a_minus_1 + a_plus_1 * cos_omega) * a0_inverse,
+             A * (a_plus_1 + a_minus_1_times_cos - beta) * a0_inverse,
+             2 * (a_minus_1 - a_plus_1 * cos_omega) * a0_inverse,
+             (a_plus_1 - a_minus_1_times_cos - beta) * a0_inverse };
+}
+
+inline BiquadCoefficients make_notch(double sample_rate, float frequency, float quality) noexcept
+{
+    auto n = 1 / std::tan(juce::MathConstants<double>::pi * frequency / sample_rate);
+    auto n_squared = n * n;
+    auto c1 = 1 / (1 + n / (double)quality + n_squared);
+
+    return { c1 * (1 + n_squared), 2 * c1 * (1 - n_squared), c1 * (1 + n_squared), c1 * 2 * (1 - n_squared), c1 * (1 - n / (double)quality + n_squared) };
+}
+
+//==============================================================================
+// The low cut is a high pass, the high cut a low pass
+enum class cut_type
+{
+    high_pass,
+    low_pass
+};
+
+inline int get_num_cut_sections(slope cut_slope) noexcept
+{
+    return (int)cut_slope + 1;
+}
+
+// 1 / (2 cos ((2i + 1) pi / 2N)) for each section i of an order N = 2 * num_sections cascade
+inline constexpr double butterworth_section_q[4][4] = {
+    { 0.70710678118654752 },
+    { 0.54119610014619699, 1.30656296487637653 },
+    { 0.51763809020504152, 0.70710678118654752, 1.93185165257813657 },
+    { 0.50979557910415917, 0.60134488693504529, 0.89997622313641570, 2.56291544774150617 }
+};
+
+inline double get_butterworth_section_q(slope cut_slope, int section) noexcept
+{
+    return butterworth_section_q[(int)cut_slope][section];
+}
+
+// Calls design with a std::integral_constant holding the number of sections for the slope
+// and returns what it returns. The only place a cut's slope is switched on
+template <typename Design>
+inline int dispatch_cut_slope(slope cut_slope, Design&& design) noexcept
+{
+    switch (cut_slope)
+    {
+        case slope::slope_12: return design(std::integral_constant<int, 1>());
+        case slope::slope_24: return design(std::integral_constant<int, 2>());
+        case slope::slope_36: return design(std::integral_constant<int, 3>());
+        case slope::slope_48: break;
+    }
+
+    return design(std::integral_constant<int, 4>());
+}
+
+// tan() and the matched exp() both need the corner below Nyquist, whatever the host's rate
+inline double get_cut_frequency(double sample_rate, float frequency) noexcept
+{
+    return juce::jmin((double)frequency, 0.49 * sample_rate);
+}
+
+// Butterworth cut of 12 * num_sections dB/Oct, returns the number of sections written
+template <cut_type type, int num_sections>
+inline int make_butterworth_cut(double sample_rate, float frequency, BiquadCoefficients* sections) noexcept
+{
+    auto n = std::tan(juce::MathConstants<double>::pi * get_cut_frequency(sample_rate, frequency) / sample_rate);
+    auto n_squared = n * n;
+
+    for (int i = 0; i < num_sections; ++i)
+    {
+        auto inverse_q = 1 / butterworth_section_q[num_sections - 1][i];
+        auto c1 = 1 / (1 + inverse_q * n + n_squared);
+        auto b0 = type == cut_type::high_pass ? c1 : c1 * n_squared;
+        auto b1 = type == cut_type::high_pass ? -2 * b0 : 2 * b0;
+        sections[i] = { b0, b1, b0, c1 * 2 * (n_squared - 1), c1 * (1 - inverse_q * n + n_squared) };
+    }
+
+    return num_sections;
+}
+
+inline int make_butterworth_cut(cut_type type, double sample_rate, float frequency, slope cut_slope, BiquadCoefficients* sections) noexcept
+{
+    return dispatch_cut_slope(cut_slope, [&](auto num_sections)
+    {
+        constexpr int count = decltype(num_sections)::value;
+        return type == cut_type::high_pass ? make_butterworth_cut<cut_type::high_pass, count>(sample_rate, frequency, sections)
+                                           : make_butterworth_cut<cut_type::low_pass, count>(sample_rate, frequency, sections);
+    });
+}
+
+//==============================================================================
+struct MatchedPoles
+{
+    double a1, a2;
+
+    // Squared magnitude terms of the denominator and the phi weights at omega,
+    // |H|^2 = (B0 phi0 + B1 phi1 + B2 phi2) / (A0 phi0 + A1 phi1 + A2 phi2)
+    double A0() const noexcept { return (1 + a1 + a2) * (1 + a1 + a2); }
+    double A1() const noexcept { return (1 - a1 + a2) * (1 - a1 + a2); }
+    double A2() const noexcept { return -4 * a2; }
+};
+
+inline MatchedPoles make_matched_poles(double omega, double quality) noexcept
+{
+    auto zeta = 1 / (2 * quality);
+    auto decay = std::exp(-zeta * omega);
+    auto a1 = zeta <= 1 ? -2 * decay * std::cos(std::sqrt(1 - zeta * zeta) * omega)
+                        : -2 * decay * std::cosh(std::sqrt(zeta * zeta - 1) * omega);
+    return { a1, decay * decay };
+}
+
+inline BiquadCoefficients make_matched_peak_filter(double sample_rate, float frequency, float quality, float gain_in_decibels) noexcept
+{
+    // Same prototype as make_peak_filter, whose poles sit at Q * sqrt (G)
+    auto gain = (double)juce::Decibels::decibelsToGain(gain_in_decibels);
+    auto omega = 2 * juce::MathConstants<double>::pi * juce::jmax(frequency, 2.f) / sample_rate;
+    auto poles = make_matched_poles(omega, juce::jmax(0.01, (double)quality) * std::sqrt(gain));
+
+    auto phi1 = std::pow(std::sin(omega / 2), 2.0);
+    auto phi0 = 1 - phi1;
+    auto phi2 = 4 * phi0 * phi1;
+
+    auto A0 = poles.A0(), A1 = poles.A1(), A2 = poles.A2();
+    auto R1 = (A0 * phi0 + A1 * phi1 + A2 * phi2) * gain * gain;
+    auto R2 = (-A0 + A1 + 4 * (phi0 - phi1) * A2) * gain * gain;
+
+    auto B0 = A0;
+    auto B2 = (R1 - R2 * phi1 - B0) / (4 * phi1 * phi1);
+    auto B1 = juce::jmax(0.0, R2 + B0 + 4 * (phi1 - phi0) * B2);
+
+    auto W = 0.5 * (std::sqrt(B0) + std::sqrt(B1));
+    auto b0 = 0.5 * (W + std::sqrt(juce::jmax(0.0, W * W + B2)));
+    auto b1 = 0.5 * (std::sqrt(B0) - std::sqrt(B1));
+    auto b2 = -B2 / (4 * b0);
+
+    return { b0, b1, b2, poles.a1, poles.a2 };
+}
+
+// Butterworth cut with every section matched on its own, returns the number of sections written.
+// A high pass section is pinned at Nyquist and at the corner, a low pass section at DC and the corner
+template <cut_type type, int num_sections>
+inline int make_matched_butterworth_cut(double sample_rate, float frequency, BiquadCoefficients* sections) noexcept
+{
+    auto omega = 2 * juce::MathConstants<double>::pi * get_cut_frequency(sample_rate, frequency) / sample_rate;
+    auto phi1 = std::pow(std::sin(omega / 2), 2.0);
+    auto phi0 = 1 - phi1;
+    auto phi2 = 4 * phi0 * phi1;
+
+    for (int i = 0; i < num_sections; ++i)
+    {
+        auto quality = butterworth_section_q[num_sections - 1][i];
+        auto poles = make_matched_poles(omega, quality);
+        auto R1 = poles.A0() * phi0 + poles.A1() * phi1 + poles.A2() * phi2;
+
+        if constexpr (type == cut_type::high_pass)
+        {
+            auto b0 = quality * std::sqrt(R1) / (4 * phi1);
+            sections[i] = { b0, -2 * b0, b0, poles.a1, poles.a2 };
+        }
+        else
+        {
+            auto B0 = poles.A0();
+            auto B1 = juce::jmax(0.0, (R1 * quality * quality - B0 * phi0) / phi1);
+            auto b0 = 0.5 * (std::sqrt(B0) + std::sqrt(B1));
+            sections[i] = { b0, std::sqrt(B0) - b0, 0.0, poles.a1, poles.a2 };
+        }
+    }
+
+    return num_sections;
+}
+
+inline int make_matched_butterworth_cut(cut_type type, double sample_rate, float frequency, slope cut_slope, BiquadCoefficients* sections) noexcept
+{
+    return dispatch_cut_slope(cut_slope, [&](auto num_sections)
+    {
+        constexpr int count = decltype(num_sections)::value;
+        return type == cut_type::high_pass ? make_matched_butterworth_cut<cut_type::high_pass, count>(sample_rate, frequency, sections)
+                                           : make_matched_butterworth_cut<cut_type::low_pass, count>(sample_rate, frequency, sections);
+    });
+}
+
+//==============================================================================
+inline int make_cut_filter(design_mode mode, cut_type type, double sample_rate, float frequency, slope cut_slope, BiquadCoefficients* sections) noexcept
+{
+    return mode == design_mode::analog_matched ? make_matched_butterworth_cut(type, sample_rate, frequency, cut_slope, sections)
+                                               : make_butterworth_cut(type, sample_rate, frequency, cut_slope, sections);
+}
+
+// Analog matched only changes the peaks, shelves and notches are always bilinear
+inline BiquadCoefficients make_band_filter(design_mode mode, double sample_rate, const BandSettings& band) noexcept
+{
+    auto quality = juce::jmax(0.01f, band.quality);
+    switch (band.type)
+    {
+        case band_type::low_shelf:  return make_low_shelf(sample_rate, band.freq, quality, band.gain_in_decibels);
+        case band_type::high_shelf: return make_high_shelf(sample_rate, band.freq, quality, band.gain_in_decibels);
+        case band_type::notch:      return make_notch(sample_rate, band.freq, quality);
+        case band_type::peak:       break;
+    }
+
+    return mode == design_mode::analog_matched ? make_matched_peak_filter(sample_rate, band.freq, quality, band.gain_in_decibels)
+                                               : make_peak_filter(sample_rate, band.freq, quality, band.gain_in_decibels);
+}
+
+//==============================================================================
+// Samples until the slower pole of the section has decayed by decay_in_decibels,
+// or -1 if the section doesn't decay at all
+inline double get_decay_samples(const BiquadCoefficients& c, double decay_in_decibels) noexcept
+{
+    auto a1 = (double)c.a1, a2 = (double)c.a2;
+    auto discriminant = a1 * a1 - 4 * a2;
+    auto radius = discriminant < 0 ? std::sqrt(a2) : 0.5 * (std::abs(a1) + std::sqrt(discriminant));
+
+    if (radius >= 1)
+        return -1;
+    if (radius <= 0)
+        return 2;
+
+    return decay_in_decibels / (-20 * std::log10(radius)) + 2;
+}
+
+//==============================================================================
+// Multiplies magnitudes_squared[i] by |H|^2 of the section at the angular frequency whose
+// cos (w) and cos (2w) are given, a plain loop over arrays so it vectorises
+inline void multiply_by_magnitude_squared(const BiquadCoefficients& c, const float* cos_w, const float* cos_2w, float* magnitudes_squared, int num_points) noexcept
+{
+    auto numerator_0 = (float)(c.b0 * c.b0 + c.b1 * c.b1 + c.b2 * c.b2);
+    auto numerator_1 = (float)(2 * (c.b0 * c.b1 + c.b1 * c.b2));
+    auto numerator_2 = (float)(2 * c.b0 * c.b2);
+    auto denominator_0 = (float)(1 + c.a1 * c.a1 + c.a2 * c.a2);
+    auto denominator_1 = (float)(2 * (c.a1 + c.a1 * c.a2));
+    auto denominator_2 = (float)(2 * c.a2);
+
+    for (int i = 0; i < num_points; ++i)
+    {
+        auto numerator = numerator_0 + numerator_1 * cos_w[i] + numerator_2 * cos_2w[i];
+        auto denominator = denominator_0 + denominator_1 * cos_w[i] + denominator_2 * cos_2w[i];
+        magnitudes_squared[i] *= numerator / denominator;
+    }
+}
@@ -0,0 +1,138 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Parameter IDs and the plain settings struct the filter chain is built from.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#define LOW_CUT_FREQ "LowCut Freq"
+#define HIGH_CUT_FREQ "HighCut Freq"
+#define PEAK_FREQ "Peak Freq"
+#define PEAK_QUALITY "Peak Quality"
+#define PEAK_GAIN "Peak Gain"
+#define LOW_CUT_SLOPE "LowCut Slope"
+#define HIGH_CUT_SLOPE "HighCut Slope"
+#define SMOOTHING "Smoothing"
+#define DESIGN_MODE "Design Mode"
+#define PHASE_MODE "Phase Mode"
+#define LINEAR_PHASE_LENGTH "Linear Phase Length"
+#define LINEAR_PHASE_PARTITIONING "Linear Phase Partitioning"
+#define FILTER_TOPOLOGY "Filter Topology"
+#define MORPH "Morph"
+#define MORPH_TARGET "Morph Target"
+#define DYNAMIC_SOURCE "Dynamic"
+#define DYNAMIC_THRESHOLD "Dynamic Threshold"
+#define DYNAMIC_RATIO "Dynamic Ratio"
+#define DYNAMIC_ATTACK "Dynamic Attack"
+#define DYNAMIC_RELEASE "Dynamic Release"
+#define LOW_CUT_MODE "Low Cut Mode"
+
+// Per band parameter names, see get_band_parameter_id
+#define BAND_FREQ "Freq"
+#define BAND_GAIN "Gain"
+#define BAND_QUALITY "Quality"
+#define BAND_TYPE "Type"
+
+constexpr int num_bands = 8;
+
+// Band 1 keeps the original "Peak ..." IDs so old sessions still load, the others are "Band 2 Freq" and so on
+juce::String get_band_parameter_id(int band, const juce::String& name);
+
+enum class slope
+{
+    slope_12,
+    slope_24,
+    slope_36,
+    slope_48
+};
+
+// How the analog prototypes are mapped to biquads
+enum class design_mode
+{
+    bilinear,
+    analog_matched
+};
+
+// Which structure runs the minimum phase chain
+enum class filter_topology
+{
+    biquad,
+    state_variable
+};
+
+enum class band_type
+{
+    peak,
+    low_shelf,
+    high_shelf,
+    notch
+};
+
+// What drives the gain of band 1 when it's dynamic
+enum class dynamic_source
+{
+    off,
+    input,
+    sidechain
+};
+
+struct BandSettings
+{
+    float freq{ 750.f }, gain_in_decibels{ 0 }, quality{ 1.f };
+    band_type type{ band_type::peak };
+
+    // Its gain follows an envelope, so it has to stay in the chain even at 0 dB
+    bool dynamic{ false };
+
+    // A 0 dB peak or shelf is unity and is skipped entirely
+    bool is_active() const noexcept { return dynamic || type == band_type::notch || gain_in_decibels != 0.f; }
+};
+
+bool operator==(const BandSettings&, const BandSettings&);
+
+struct ChainSettings
+{
+    std::array<BandSettings, num_bands> bands;
+    // The high cut is always in the chain, so it starts open like its parameter
+    float low_cut_freq{ 0 }, high_cut_freq{ 20000.f };
+    slope low_cut_slope{slope::slope_12}, high_cut_slope{slope::slope_12};
+    design_mode filter_design{ design_mode::bilinear };
+};
+
+bool operator==(const ChainSettings&, const ChainSettings&);
+bool operator!=(const ChainSettings&, const ChainSettings&);
+
+// Writes every value back to its parameter and notifies the host, the way recalling a snapshot does
+void set_chain_settings(juce::AudioProcessorValueTreeState&, const ChainSettings&);
+
+//==============================================================================
+/**
+    The raw parameter values looked up once, so reading the settings is just
+    a handful of atomic loads instead of string-keyed lookups.
+*/
+struct ChainParameters
+{
+    void attach(juce::AudioProcessorValueTreeState&);
+    ChainSettings load() const noexcept;
+
+    struct BandParameters
+    {
+        std::atomic<float>* freq{ nullptr };
+        std::atomic<float>* gain{ nullptr };
+        std::atomic<float>* quality{ nullptr };
+        std::atomic<float>* type{ nullptr };
+    };
+
+    std::array<BandParameters, num_bands> bands;
+    std::atomic<float>* low_cut_freq{ nullptr };
+    std::atomic<float>* high_cut_freq{ nullptr };
+    std::atomic<float>* low_cut_slope{ nullptr };
+    std::atomic<float>* high_cut_slope{ nullptr };
+    std::atomic<float>* filter_design{ nullptr };
+    std::atomic<float>* dynamic_source{ nullptr };
+};
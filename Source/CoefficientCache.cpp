@@ -0,0 +1,181 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Process-wide cache of designed filter sections.
+
+  ==============================================================================
+*/
+
+#include "CoefficientCache.h"
+
+CoefficientCache::CoefficientCache()
+    : entries(new Entry[num_ways * num_sets]),
+      next_victim(new std::atomic<juce::uint32>[num_sets])
+{
+    for (int i = 0; i < num_sets; ++i)
+        next_victim[i] = 0;
+}
+
+bool CoefficientCache::make_key(filter_type type, double sample_rate, float frequency, float quality, float gain_in_decibels, int order, juce::uint64& key) noexcept
+{
+    // The same steps as create_parameter_layout. The ranges snap in float, so
+    // allow for rounding, but anything really in between isn't cached
+    auto on_grid = [](double value, int index) { return std::abs(value - (double)index) < 1.0e-3; };
+    auto rate_index = juce::roundToInt(sample_rate);
+    auto frequency_index = juce::roundToInt(frequency);
+    auto quality_index = juce::roundToInt(quality * 20.f);
+    auto gain_index = juce::roundToInt(gain_in_decibels * 2.f);
+
+    if (!on_grid(sample_rate, rate_index) || !on_grid(frequency, frequency_index)
+        || !on_grid(quality * 20.0, quality_index) || !on_grid(gain_in_decibels * 2.0, gain_index))
+        return false;
+
+    if (!juce::isPositiveAndBelow(rate_index, 1 << 22) || !juce::isPositiveAndBelow(frequency_index, 1 << 16)
+        || !juce::isPositiveAndBelow(quality_index + 64, 1 << 10) || !juce::isPositiveAndBelow(gain_index + 128, 1 << 8))
+        return false;
+
+    // 22 bits rate | 16 bits frequency | 10 bits Q | 8 bits gain | 4 bits order | 4 bits type
+    key = ((juce::uint64)rate_index << 42)
+        | ((juce::uint64)frequency_index << 26)
+        | ((juce::uint64)(quality_index + 64) << 16)
+        | ((juce::uint64)(gain_index + 128) << 8)
+        | ((juce::uint64)order << 4)
+        | (juce::uint64)type;
+    return true;
+}
+
+int CoefficientCache::get_set_index(juce::uint64 key) noexcept
+{
+    return (int)((key * 0x9E3779B97F4A7C15ull) >> 54) & (num_sets - 1);
+}
+
+bool CoefficientCache::find(juce::uint64 key, BiquadCoefficients* sections, int capacity, int& num_sections) const noexcept
+{
+    auto* set = entries.get() + get_set_index(key) * num_ways;
+    for (int way = 0; way < num_ways; ++way)
+    {
+        auto& entry = set[way];
+        auto sequence = entry.sequence.load(std::memory_order_acquire);
+        if ((sequence & 1) != 0 || entry.key.load(std::memory_order_relaxed) != key)
+            continue;
+
+        // A writer may be storing another key with another section count meanwhile, so
+        // nothing reaches the caller before the sequence says the copy is whole
+        std::array<BiquadCoefficients, max_sections> copy;
+        auto num_copied = juce::jlimit(0, max_sections, entry.num_sections.load(std::memory_order_relaxed));
+        for (int i = 0; i < num_copied; ++i)
+        {
+            auto& values = entry.sections[(size_t)i];
+            copy[(size_t)i] = { values[0].load(std::memory_order_relaxed), values[1].load(std::memory_order_relaxed), values[2].load(std::memory_order_relaxed),
+                                values[3].load(std::memory_order_relaxed), values[4].load(std::memory_order_relaxed) };
+        }
+
+        // A writer got in while we were copying, treat it as a miss
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry.sequence.load(std::memory_order_relaxed) != sequence || num_copied > capacity)
+            continue;
+
+        std::copy(copy.begin(), copy.begin() + num_copied, sections);
+        num_sections = num_copied;
+        return true;
+    }
+    return false;
+}
+
+void CoefficientCache::insert(juce::uint64 key, const BiquadCoefficients* sections, int num_sections) noexcept
+{
+    auto set_index = get_set_index(key);
+    auto* set = entries.get() + set_index * num_ways;
+
+    Entry* entry = nullptr;
+    for (int way = 0; way < num_ways && entry == nullptr; ++way)
+        if (set[way].key.load(std::memory_order_relaxed) == 0)
+            entry = set + way;
+
+    // The set is full, evict round robin
+    if (entry == nullptr)
+        entry = set + (int)(next_victim[set_index]++ % (juce::uint32)num_ways);
+
+    auto sequence = entry->sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) != 0 || !entry->sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+        return;
+    std::atomic_thread_fence(std::memory_order_release);
+
+    jassert(num_sections <= max_sections);
+    entry->key.store(key, std::memory_order_relaxed);
+    entry->num_sections.store(num_sections, std::memory_order_relaxed);
+    for (int i = 0; i < juce::jmin(num_sections, max_sections); ++i)
+    {
+        auto& values = entry->sections[(size_t)i];
+        values[0].store(sections[i].b0, std::memory_order_relaxed);
+        values[1].store(sections[i].b1, std::memory_order_relaxed);
+        values[2].store(sections[i].b2, std::memory_order_relaxed);
+        values[3].store(sections[i].a1, std::memory_order_relaxed);
+        values[4].store(sections[i].a2, std::memory_order_relaxed);
+    }
+
+    entry->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+BiquadCoefficients CoefficientCache::get_band_filter(design_mode mode, double sample_rate, const BandSettings& band) noexcept
+{
+    auto type = filter_type::peak;
+    switch (band.type)
+    {
+        case band_type::low_shelf:  type = filter_type::low_shelf; break;
+        case band_type::high_shelf: type = filter_type::high_shelf; break;
+        case band_type::notch:      type = filter_type::notch; break;
+        case band_type::peak:       type = mode == design_mode::analog_matched ? filter_type::matched_peak : filter_type::peak; break;
+    }
+
+    BiquadCoefficients section;
+    int num_sections = 0;
+    juce::uint64 key;
+
+    auto gain_in_decibels = band.type == band_type::notch ? 0.f : band.gain_in_decibels;
+    if (!make_key(type, sample_rate, band.freq, band.quality, gain_in_decibels, 2, key))
+        return make_band_filter(mode, sample_rate, band);
+
+    if (!find(key, &section, 1, num_sections))
+    {
+        section = make_band_filter(mode, sample_rate, band);
+        insert(key, &section, 1);
+    }
+    return section;
+}
+
+int CoefficientCache::get_cut_filter(design_mode mode, cut_type type, double sample_rate, float frequency, slope cut_slope, BiquadCoefficients* sections) noexcept
+{
+    auto design = [&] { return make_cut_filter(mode, type, sample_rate, frequency, cut_slope, sections); };
+
+    auto matched = mode == design_mode::analog_matched;
+    auto key_type = type == cut_type::high_pass ? (matched ? filter_type::matched_high_pass : filter_type::high_pass)
+                                                : (matched ? filter_type::matched_low_pass : filter_type::low_pass);
+
+    int num_sections = 0;
+    juce::uint64 key;
+
+    if (!make_key(key_type, sample_rate, frequency, 0.f, 0.f, 2 * get_num_cut_sections(cut_slope), key))
+        return design();
+
+    if (!find(key, sections, max_sections, num_sections))
+    {
+        num_sections = design();
+        insert(key, sections, num_sections);
+    }
+    return num_sections;
+}
+
+void CoefficientCache::warm_up(const ChainSettings& chain_settings) noexcept
+{
+    std::array<BiquadCoefficients, 4> sections;
+    for (auto sample_rate : { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 })
+    {
+        for (auto& band : chain_settings.bands)
+            if (band.is_active())
+                get_band_filter(chain_settings.filter_design, sample_rate, band);
+        get_cut_filter(chain_settings.filter_design, cut_type::high_pass, sample_rate, chain_settings.low_cut_freq, chain_settings.low_cut_slope, sections.data());
+        get_cut_filter(chain_settings.filter_design, cut_type::low_pass, sample_rate, chain_settings.high_cut_freq, chain_settings.high_cut_slope, sections.data());
+    }
+}
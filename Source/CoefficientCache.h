@@ -0,0 +1,80 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Process-wide cache of designed filter sections.
+
+    Every parameter is quantised (1 Hz, 0.05 Q, 0.5 dB, four slopes), so
+    instances in the same host very often want exactly the same sections.
+    All SEQ instances share one fixed-size, 4-way set associative table
+    through juce::SharedResourcePointer. Lookups are lock-free (each entry is
+    guarded by a sequence counter) and a writer that finds an entry busy just
+    skips caching, so neither side ever blocks.
+
+    The table is allocated once per process: 1024 sets of 4 entries, each
+    176 bytes of double sections, about 720 KB in all.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadDesign.h"
+
+#ifndef SEQ_WARM_UP_COEFFICIENT_CACHE
+ // Designs the current settings at the common host rates in prepareToPlay
+ #define SEQ_WARM_UP_COEFFICIENT_CACHE 1
+#endif
+
+class CoefficientCache
+{
+public:
+    CoefficientCache();
+
+    // Both fall back to designing directly (without caching) for values off
+    // the parameter grid, e.g. while automation is being smoothed
+    BiquadCoefficients get_band_filter(design_mode, double sample_rate, const BandSettings&) noexcept;
+    int get_cut_filter(design_mode, cut_type, double sample_rate, float frequency, slope cut_slope, BiquadCoefficients* sections) noexcept;
+
+    void warm_up(const ChainSettings&) noexcept;
+
+private:
+    enum class filter_type : juce::uint64
+    {
+        peak = 1,
+        high_pass = 2,
+        matched_peak = 3,
+        matched_high_pass = 4,
+        low_shelf = 5,
+        high_shelf = 6,
+        notch = 7,
+        low_pass = 8,
+        matched_low_pass = 9
+    };
+
+    static constexpr int num_ways = 4, num_sets = 1024, max_sections = 4;
+
+    // A reader can copy an entry while a writer replaces it, so every field is a relaxed
+    // atomic and the sequence decides afterwards whether the copy counts
+    struct Entry
+    {
+        // The two 32 bit fields share a word, otherwise each would be padded out to 8 bytes
+        std::atomic<juce::uint32> sequence{ 0 };
+        std::atomic<int> num_sections{ 0 };
+        std::atomic<juce::uint64> key{ 0 };
+        std::array<std::array<std::atomic<double>, 5>, max_sections> sections;
+    };
+
+    std::unique_ptr<Entry[]> entries;
+    std::unique_ptr<std::atomic<juce::uint32>[]> next_victim;
+
+    static bool make_key(filter_type, double sample_rate, float frequency, float quality, float gain_in_decibels, int order, juce::uint64& key) noexcept;
+    static int get_set_index(juce::uint64 key) noexcept;
+
+    // Writes to sections only on a hit, and only if the entry fits in capacity
+    bool find(juce::uint64 key, BiquadCoefficients* sections, int capacity, int& num_sections) const noexcept;
+    void insert(juce::uint64 key, const BiquadCoefficients* sections, int num_sections) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoefficientCache)
+};
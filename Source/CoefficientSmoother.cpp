@@ -0,0 +1,88 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Ramps the continuous parameters and redesigns the coefficients at a
+    fixed control rate while they move.
+
+  ==============================================================================
+*/
+
+#include "CoefficientSmoother.h"
+
+void CoefficientSmoother::prepare(double new_sample_rate, const ChainSettings& chain_settings)
+{
+    sample_rate = new_sample_rate;
+    low_cut_freq.reset(sample_rate, ramp_length_seconds);
+    high_cut_freq.reset(sample_rate, ramp_length_seconds);
+    for (auto& band : bands)
+    {
+        band.freq.reset(sample_rate, ramp_length_seconds);
+        band.gain_in_decibels.reset(sample_rate, ramp_length_seconds);
+        band.quality.reset(sample_rate, ramp_length_seconds);
+    }
+
+    target = chain_settings;
+    snap_to_target();
+}
+
+void CoefficientSmoother::set_target(const ChainSettings& chain_settings) noexcept
+{
+    if (chain_settings == target)
+        return;
+
+    target = chain_settings;
+    low_cut_freq.setTargetValue(target.low_cut_freq);
+    high_cut_freq.setTargetValue(target.high_cut_freq);
+    for (size_t i = 0; i < bands.size(); ++i)
+    {
+        bands[i].freq.setTargetValue(target.bands[i].freq);
+        bands[i].gain_in_decibels.setTargetValue(target.bands[i].gain_in_decibels);
+        bands[i].quality.setTargetValue(target.bands[i].quality);
+    }
+}
+
+void CoefficientSmoother::snap_to_target() noexcept
+{
+    low_cut_freq.setCurrentAndTargetValue(target.low_cut_freq);
+    high_cut_freq.setCurrentAndTargetValue(target.high_cut_freq);
+    for (size_t i = 0; i < bands.size(); ++i)
+    {
+        bands[i].freq.setCurrentAndTargetValue(target.bands[i].freq);
+        bands[i].gain_in_decibels.setCurrentAndTargetValue(target.bands[i].gain_in_decibels);
+        bands[i].quality.setCurrentAndTargetValue(target.bands[i].quality);
+    }
+}
+
+bool CoefficientSmoother::is_smoothing() const noexcept
+{
+    if (low_cut_freq.isSmoothing() || high_cut_freq.isSmoothing())
+        return true;
+
+    for (auto& band : bands)
+        if (band.freq.isSmoothing() || band.gain_in_decibels.isSmoothing() || band.quality.isSmoothing())
+            return true;
+
+    return false;
+}
+
+ChainSettings CoefficientSmoother::advance(int num_samples) noexcept
+{
+    // Slopes and band types are discrete, they switch straight to the target.
+    // A gain ramping to 0 dB lands on exactly 0, so the band drops out when it ends.
+    auto chain_settings = target;
+    chain_settings.low_cut_freq = low_cut_freq.skip(num_samples);
+    chain_settings.high_cut_freq = high_cut_freq.skip(num_samples);
+    for (size_t i = 0; i < bands.size(); ++i)
+    {
+        chain_settings.bands[i].freq = bands[i].freq.skip(num_samples);
+        chain_settings.bands[i].gain_in_decibels = bands[i].gain_in_decibels.skip(num_samples);
+        chain_settings.bands[i].quality = bands[i].quality.skip(num_samples);
+    }
+    return chain_settings;
+}
+
+void CoefficientSmoother::advance(int num_samples, CoefficientSet& coefficient_set) noexcept
+{
+    coefficient_set = design_coefficients(advance(num_samples), sample_rate);
+}
@@ -0,0 +1,50 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Ramps the continuous parameters and redesigns the coefficients at a
+    fixed control rate while they move, so automation doesn't zipper even
+    with large host blocks.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterDesigner.h"
+
+class CoefficientSmoother
+{
+public:
+    void prepare(double sample_rate, const ChainSettings&);
+
+    // Audio thread: cheap, only starts a ramp when a value actually changed
+    void set_target(const ChainSettings&) noexcept;
+    void snap_to_target() noexcept;
+
+    bool is_smoothing() const noexcept;
+
+    // Moves every ramp on by num_samples and returns the settings at that point
+    ChainSettings advance(int num_samples) noexcept;
+
+    // The same, designing the biquad coefficients for that point
+    void advance(int num_samples, CoefficientSet&) noexcept;
+
+private:
+    using frequency_value = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>;
+    using linear_value = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>;
+
+    static constexpr double ramp_length_seconds = 0.05;
+
+    struct BandValues
+    {
+        frequency_value freq;
+        linear_value gain_in_decibels, quality;
+    };
+
+    frequency_value low_cut_freq, high_cut_freq;
+    std::array<BandValues, num_bands> bands;
+    ChainSettings target;
+    double sample_rate{ 44100.0 };
+};
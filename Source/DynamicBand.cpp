@@ -0,0 +1,83 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Band 1 as a dynamic EQ band.
+
+  ==============================================================================
+*/
+
+#include "DynamicBand.h"
+
+void DynamicParameters::attach(juce::AudioProcessorValueTreeState& _audio_processor_value_tree_state)
+{
+    source = _audio_processor_value_tree_state.getRawParameterValue(DYNAMIC_SOURCE);
+    threshold = _audio_processor_value_tree_state.getRawParameterValue(DYNAMIC_THRESHOLD);
+    ratio = _audio_processor_value_tree_state.getRawParameterValue(DYNAMIC_RATIO);
+    attack = _audio_processor_value_tree_state.getRawParameterValue(DYNAMIC_ATTACK);
+    release = _audio_processor_value_tree_state.getRawParameterValue(DYNAMIC_RELEASE);
+}
+
+DynamicSettings DynamicParameters::load() const noexcept
+{
+    DynamicSettings setting;
+    setting.source = static_cast<dynamic_source>(source->load());
+    setting.threshold_in_decibels = threshold->load();
+    setting.ratio = ratio->load();
+    setting.attack_ms = attack->load();
+    setting.release_ms = release->load();
+    return setting;
+}
+
+//==============================================================================
+void DynamicBand::prepare(double new_sample_rate) noexcept
+{
+    sample_rate = new_sample_rate;
+    terms_freq = terms_quality = 0.f;
+    reset();
+}
+
+void DynamicBand::reset() noexcept
+{
+    envelope = 0.f;
+}
+
+template <typename SampleType>
+BiquadCoefficients DynamicBand::process(const juce::dsp::AudioBlock<SampleType>& detector, const BandSettings& band, design_mode mode, const DynamicSettings& dynamic_settings) noexcept
+{
+    auto num_samples = (int)detector.getNumSamples();
+    auto peak = 0.f;
+    for (size_t channel = 0; channel < detector.getNumChannels(); ++channel)
+    {
+        auto range = juce::FloatVectorOperations::findMinAndMax(detector.getChannelPointer(channel), num_samples);
+        peak = juce::jmax(peak, (float)-range.getStart(), (float)range.getEnd());
+    }
+
+    auto time_ms = peak > envelope ? dynamic_settings.attack_ms : dynamic_settings.release_ms;
+    auto coefficient = (float)std::exp(-num_samples / (juce::jmax(0.01f, time_ms) * 0.001 * sample_rate));
+    envelope = peak + coefficient * (envelope - peak);
+
+    auto over = juce::Decibels::gainToDecibels(envelope, -120.f) - dynamic_settings.threshold_in_decibels;
+    auto offset = over > 0.f ? -over * (1.f - 1.f / juce::jmax(1.f, dynamic_settings.ratio)) : 0.f;
+    auto gain_in_decibels = juce::jlimit(-24.f, 24.f, band.gain_in_decibels + offset);
+
+    if (band.type == band_type::peak && mode == design_mode::bilinear)
+    {
+        // Same quality limit as make_band_filter, so a settled envelope lands on the static design
+        auto quality = juce::jmax(0.01f, band.quality);
+        if (band.freq != terms_freq || quality != terms_quality)
+        {
+            peak_terms = make_peak_filter_terms(sample_rate, band.freq, quality);
+            terms_freq = band.freq;
+            terms_quality = quality;
+        }
+        return peak_terms.make(gain_in_decibels);
+    }
+
+    auto dynamic_band = band;
+    dynamic_band.gain_in_decibels = gain_in_decibels;
+    return make_band_filter(mode, sample_rate, dynamic_band);
+}
+
+template BiquadCoefficients DynamicBand::process<float>(const juce::dsp::AudioBlock<float>&, const BandSettings&, design_mode, const DynamicSettings&) noexcept;
+template BiquadCoefficients DynamicBand::process<double>(const juce::dsp::AudioBlock<double>&, const BandSettings&, design_mode, const DynamicSettings&) noexcept;
@@ -0,0 +1,70 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Band 1 as a dynamic EQ band.
+
+    An envelope follower on the input or the sidechain pushes the band's
+    gain down once the level passes the threshold, like a compressor
+    working on that band only. The envelope runs at the control rate:
+    each sub-block's peak across all channels is found with vectorised
+    min/max, and attack or release is applied once per sub-block with its
+    time constant scaled to the sub-block length.
+
+    A bilinear peak keeps its frequency and Q terms between sub-blocks and
+    only redoes the gain part, everything else falls back to the full
+    design of that one band.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "BiquadDesign.h"
+
+struct DynamicSettings
+{
+    dynamic_source source{ dynamic_source::off };
+    float threshold_in_decibels{ -20.f }, ratio{ 2.f }, attack_ms{ 5.f }, release_ms{ 100.f };
+};
+
+// Same idea as ChainParameters, the raw values looked up once
+struct DynamicParameters
+{
+    void attach(juce::AudioProcessorValueTreeState&);
+    DynamicSettings load() const noexcept;
+
+    std::atomic<float>* source{ nullptr };
+    std::atomic<float>* threshold{ nullptr };
+    std::atomic<float>* ratio{ nullptr };
+    std::atomic<float>* attack{ nullptr };
+    std::atomic<float>* release{ nullptr };
+};
+
+class DynamicBand
+{
+public:
+    DynamicBand() = default;
+
+    // The envelope still needs a control rate when smoothing is off
+    static constexpr int default_control_rate = 32;
+
+    void prepare(double sample_rate) noexcept;
+    void reset() noexcept;
+
+    // Follows the detector over one sub-block and returns the band's coefficients
+    // for the gain the envelope leaves it at
+    template <typename SampleType>
+    BiquadCoefficients process(const juce::dsp::AudioBlock<SampleType>& detector, const BandSettings&, design_mode, const DynamicSettings&) noexcept;
+
+private:
+    double sample_rate{ 44100.0 };
+    float envelope{ 0.f };
+
+    PeakFilterTerms peak_terms;
+    float terms_freq{ 0.f }, terms_quality{ 0.f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DynamicBand)
+};
@@ -0,0 +1,134 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Filter coefficient design, kept off the audio thread.
+
+  ==============================================================================
+*/
+
+#include "FilterDesigner.h"
+
+CoefficientSet design_coefficients(const ChainSettings& chain_settings, double sample_rate) noexcept
+{
+    CoefficientSet coefficient_set;
+    std::array<BiquadCoefficients, 4> cut;
+    auto num_low_cut_sections = make_cut_filter(chain_settings.filter_design, cut_type::high_pass, sample_rate, chain_settings.low_cut_freq, chain_settings.low_cut_slope, cut.data());
+
+    for (int i = 0; i < num_low_cut_sections; ++i)
+        coefficient_set.add(CoefficientSet::low_cut_id + i, cut[(size_t)i]);
+
+    for (int band = 0; band < num_bands; ++band)
+        if (chain_settings.bands[(size_t)band].is_active())
+            coefficient_set.add(CoefficientSet::first_band_id + band, make_band_filter(chain_settings.filter_design, sample_rate, chain_settings.bands[(size_t)band]));
+
+    auto num_high_cut_sections = make_cut_filter(chain_settings.filter_design, cut_type::low_pass, sample_rate, chain_settings.high_cut_freq, chain_settings.high_cut_slope, cut.data());
+    for (int i = 0; i < num_high_cut_sections; ++i)
+        coefficient_set.add(CoefficientSet::high_cut_id + i, cut[(size_t)i]);
+
+    return coefficient_set;
+}
+
+CoefficientSet design_coefficients(const ChainSettings& chain_settings, double sample_rate, CoefficientCache& coefficient_cache) noexcept
+{
+    CoefficientSet coefficient_set;
+    std::array<BiquadCoefficients, 4> cut;
+    auto num_low_cut_sections = coefficient_cache.get_cut_filter(chain_settings.filter_design, cut_type::high_pass, sample_rate, chain_settings.low_cut_freq, chain_settings.low_cut_slope, cut.data());
+
+    for (int i = 0; i < num_low_cut_sections; ++i)
+        coefficient_set.add(CoefficientSet::low_cut_id + i, cut[(size_t)i]);
+
+    for (int band = 0; band < num_bands; ++band)
+        if (chain_settings.bands[(size_t)band].is_active())
+            coefficient_set.add(CoefficientSet::first_band_id + band, coefficient_cache.get_band_filter(chain_settings.filter_design, sample_rate, chain_settings.bands[(size_t)band]));
+
+    auto num_high_cut_sections = coefficient_cache.get_cut_filter(chain_settings.filter_design, cut_type::low_pass, sample_rate, chain_settings.high_cut_freq, chain_settings.high_cut_slope, cut.data());
+    for (int i = 0; i < num_high_cut_sections; ++i)
+        coefficient_set.add(CoefficientSet::high_cut_id + i, cut[(size_t)i]);
+
+    return coefficient_set;
+}
+
+int get_tail_samples(const CoefficientSet& coefficient_set, double sample_rate, double decay_in_decibels) noexcept
+{
+    // Each section stretches the impulse response of the ones before it by its own decay
+    auto max_tail_samples = max_tail_seconds * sample_rate;
+    auto tail_samples = 0.0;
+    for (int i = 0; i < coefficient_set.num_sections; ++i)
+    {
+        auto decay_samples = get_decay_samples(coefficient_set.sections[(size_t)i], decay_in_decibels);
+        tail_samples += decay_samples < 0 ? max_tail_samples : decay_samples;
+    }
+
+    return (int)std::ceil(juce::jmin(tail_samples, max_tail_samples));
+}
+
+//==============================================================================
+FilterDesigner::FilterDesigner(const ChainParameters& chain_parameters)
+    : parameters(chain_parameters)
+{
+    design_thread->addTimeSliceClient(this);
+}
+
+FilterDesigner::~FilterDesigner()
+{
+    design_thread->removeTimeSliceClient(this);
+}
+
+void FilterDesigner::prepare(double sample_rate)
+{
+    const juce::ScopedLock lock(design_lock);
+    current_sample_rate = sample_rate;
+
+    auto chain_settings = parameters.load();
+   #if SEQ_WARM_UP_COEFFICIENT_CACHE
+    coefficient_cache->warm_up(chain_settings);
+   #endif
+    design_and_publish(chain_settings, sample_rate);
+}
+
+int FilterDesigner::useTimeSlice()
+{
+    const juce::ScopedLock lock(design_lock);
+    auto sample_rate = current_sample_rate.load();
+    if (sample_rate <= 0.0)
+        return 50;
+
+    auto chain_settings = parameters.load();
+    if (chain_settings != last_settings || sample_rate != last_sample_rate)
+        design_and_publish(chain_settings, sample_rate);
+
+    return 10;
+}
+
+void FilterDesigner::recall(const ChainSettings& chain_settings, const CoefficientSet& coefficient_set, double sample_rate) noexcept
+{
+    const juce::ScopedLock lock(design_lock);
+    auto current_rate = current_sample_rate.load();
+    if (sample_rate == current_rate)
+        publish(last_settings, coefficient_set, sample_rate);
+    else if (current_rate > 0.0)
+        publish(last_settings, design_coefficients(chain_settings, current_rate, *coefficient_cache), current_rate);
+}
+
+CoefficientSet FilterDesigner::get_coefficients(double& sample_rate) const
+{
+    const juce::ScopedLock lock(design_lock);
+    sample_rate = last_sample_rate;
+    return last_coefficients;
+}
+
+void FilterDesigner::design_and_publish(const ChainSettings& chain_settings, double sample_rate)
+{
+    publish(chain_settings, design_coefficients(chain_settings, sample_rate, *coefficient_cache), sample_rate);
+}
+
+void FilterDesigner::publish(const ChainSettings& chain_settings, const CoefficientSet& coefficient_set, double sample_rate)
+{
+    last_coefficients = coefficient_set;
+    tail_samples = ::get_tail_samples(last_coefficients, sample_rate, -SilenceDetector::threshold_in_decibels);
+    mailbox.write(last_coefficients);
+    last_settings = chain_settings;
+    last_sample_rate = sample_rate;
+    ++generation;
+}
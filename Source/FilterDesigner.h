@@ -0,0 +1,156 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Filter coefficient design, kept off the audio thread.
+
+    A shared background thread polls the cached parameter values of every
+    SEQ instance, redesigns only when something changed and hands the finished
+    coefficient set to the audio thread through a wait-free triple buffer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "BiquadDesign.h"
+#include "CoefficientCache.h"
+#include "SilenceDetector.h"
+
+/**
+    Only the sections that actually do something, in processing order: the
+    low cut cascade, every band that isn't unity, then the high cut
+    cascade. Each section carries
+    the id of the slot it came from, so filters can keep its state while
+    other sections come and go.
+*/
+struct CoefficientSet
+{
+    static constexpr int low_cut_id = 0, first_band_id = 4, high_cut_id = first_band_id + num_bands, max_sections = high_cut_id + 4;
+
+    std::array<BiquadCoefficients, max_sections> sections;
+    std::array<int, max_sections> ids;
+    int num_sections{ 0 };
+
+    void add(int id, const BiquadCoefficients& section) noexcept
+    {
+        jassert(num_sections < max_sections);
+        ids[(size_t)num_sections] = id;
+        sections[(size_t)num_sections++] = section;
+    }
+};
+
+CoefficientSet design_coefficients(const ChainSettings&, double sample_rate) noexcept;
+CoefficientSet design_coefficients(const ChainSettings&, double sample_rate, CoefficientCache&) noexcept;
+
+// How long the cascade rings after its input stops, summed over the poles of every section
+// down to decay_in_decibels. Capped at max_tail_seconds, which is also what an unstable set reports
+int get_tail_samples(const CoefficientSet&, double sample_rate, double decay_in_decibels) noexcept;
+constexpr double max_tail_seconds = 10.0;
+
+//==============================================================================
+/**
+    Single producer / single consumer mailbox that always holds the latest
+    value. Neither side ever waits for the other.
+*/
+template <typename Type>
+class TripleBuffer
+{
+public:
+    void write(const Type& value) noexcept
+    {
+        buffers[(size_t)back_index] = value;
+        back_index = state.exchange(back_index | fresh_flag, std::memory_order_acq_rel) & index_mask;
+    }
+
+    bool read(Type& value) noexcept
+    {
+        if ((state.load(std::memory_order_acquire) & fresh_flag) == 0)
+            return false;
+
+        front_index = state.exchange(front_index, std::memory_order_acq_rel) & index_mask;
+        value = buffers[(size_t)front_index];
+        return true;
+    }
+
+private:
+    static constexpr int index_mask = 3, fresh_flag = 4;
+
+    std::array<Type, 3> buffers;
+    std::atomic<int> state{ 1 };
+    int back_index{ 0 }, front_index{ 2 };
+};
+
+//==============================================================================
+class FilterDesigner : private juce::TimeSliceClient
+{
+public:
+    explicit FilterDesigner(const ChainParameters&);
+    ~FilterDesigner() override;
+
+    // Designs synchronously for the new sample rate, call from prepareToPlay.
+    void prepare(double sample_rate);
+
+    // Audio thread: fetches the newest coefficient set, if there is one.
+    bool pull(CoefficientSet& coefficient_set) noexcept { return mailbox.read(coefficient_set); }
+
+    // Message thread: bumped every time a new set is published, so the display
+    // only has to fetch and redraw when this changes
+    juce::uint32 get_generation() const noexcept { return generation.load(); }
+    CoefficientSet get_coefficients(double& sample_rate) const;
+
+    // Any thread: publishes a set designed ahead of time, like a snapshot's, without
+    // designing it again. The caller writes chain_settings to the parameters afterwards,
+    // outside the lock. Until they arrive the designer still counts the current parameters
+    // as designed, so it doesn't replace the recalled set with them, and once they do it
+    // designs them one more time, which the cache answers with the same sections.
+    // A set designed for another sample rate is redesigned after all
+    void recall(const ChainSettings& chain_settings, const CoefficientSet& coefficient_set, double sample_rate) noexcept;
+
+    // Message thread: the same for a restored state, which has nothing designed yet. It's
+    // designed right here once the sample rate is known, so the first block after a
+    // session load only has to pick it up. Before prepare, prepare designs it
+    template <typename Callback>
+    void restore(Callback&& set_parameters)
+    {
+        const juce::ScopedLock lock(design_lock);
+        set_parameters();
+
+        auto current_rate = current_sample_rate.load();
+        if (current_rate > 0.0)
+            design_and_publish(parameters.load(), current_rate);
+    }
+
+    // Any thread: the tail of the newest set, down to SilenceDetector's threshold
+    int get_tail_samples() const noexcept { return tail_samples.load(); }
+
+    // Shared by every instance, other background design work can register on it too
+    struct DesignThread : public juce::TimeSliceThread
+    {
+        DesignThread() : juce::TimeSliceThread("SEQ Filter Design") { startThread(); }
+        ~DesignThread() override { stopThread(1000); }
+    };
+
+private:
+    int useTimeSlice() override;
+    void design_and_publish(const ChainSettings&, double sample_rate);
+    void publish(const ChainSettings&, const CoefficientSet&, double sample_rate);
+
+    const ChainParameters& parameters;
+    juce::SharedResourcePointer<DesignThread> design_thread;
+    juce::SharedResourcePointer<CoefficientCache> coefficient_cache;
+
+    juce::CriticalSection design_lock;
+    ChainSettings last_settings;
+    CoefficientSet last_coefficients;
+    double last_sample_rate{ 0.0 };
+    std::atomic<juce::uint32> generation{ 0 };
+    std::atomic<int> tail_samples{ 0 };
+    std::atomic<double> current_sample_rate{ 0.0 };
+
+    TripleBuffer<CoefficientSet> mailbox;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FilterDesigner)
+};
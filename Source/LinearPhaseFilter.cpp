@@ -0,0 +1,192 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Linear phase version of the chain.
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseFilter.h"
+
+LinearPhaseFilter::LinearPhaseFilter(const FilterDesigner& filter_designer)
+    : designer(filter_designer)
+{
+    design_thread->addTimeSliceClient(this);
+}
+
+LinearPhaseFilter::~LinearPhaseFilter()
+{
+    design_thread->removeTimeSliceClient(this);
+}
+
+juce::AudioBuffer<float> LinearPhaseFilter::design_kernel(const CoefficientSet& coefficient_set, int kernel_length)
+{
+    jassert(juce::isPowerOfTwo(kernel_length));
+    auto num_bins = kernel_length / 2 + 1;
+
+    std::vector<float> cos_w((size_t)num_bins), cos_2w((size_t)num_bins), magnitudes((size_t)num_bins, 1.f);
+    for (int bin = 0; bin < num_bins; ++bin)
+    {
+        auto omega = juce::MathConstants<double>::twoPi * bin / kernel_length;
+        cos_w[(size_t)bin] = (float)std::cos(omega);
+        cos_2w[(size_t)bin] = (float)std::cos(2.0 * omega);
+    }
+
+    for (int i = 0; i < coefficient_set.num_sections; ++i)
+        multiply_by_magnitude_squared(coefficient_set.sections[(size_t)i], cos_w.data(), cos_2w.data(), magnitudes.data(), num_bins);
+
+    // Zero phase spectrum, so the inverse transform is a real impulse symmetric around 0
+    std::vector<float> spectrum((size_t)kernel_length * 2, 0.f);
+    for (int bin = 0; bin < kernel_length; ++bin)
+        spectrum[(size_t)bin * 2] = std::sqrt(magnitudes[(size_t)juce::jmin(bin, kernel_length - bin)]);
+
+    juce::dsp::FFT fft(juce::roundToInt(std::log2(kernel_length)));
+    fft.performRealOnlyInverseTransform(spectrum.data());
+
+    // Rotate the centre to kernel_length / 2 and window with a Blackman, which is
+    // zero at tap 0 so the remaining kernel_length - 1 taps are exactly symmetric
+    juce::AudioBuffer<float> kernel(1, kernel_length);
+    auto* taps = kernel.getWritePointer(0);
+    for (int i = 0; i < kernel_length; ++i)
+    {
+        auto phase = juce::MathConstants<double>::twoPi * i / kernel_length;
+        auto window = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+        taps[i] = (float)window * spectrum[(size_t)((i + kernel_length / 2) % kernel_length)];
+    }
+
+    return kernel;
+}
+
+std::unique_ptr<juce::dsp::Convolution> LinearPhaseFilter::create_convolution(convolution_partitioning partitioning, juce::dsp::ConvolutionMessageQueue& queue)
+{
+    if (partitioning == convolution_partitioning::low_cpu)
+        return std::make_unique<juce::dsp::Convolution>(juce::dsp::Convolution::Latency{ uniform_partition_size }, queue);
+
+    return std::make_unique<juce::dsp::Convolution>(juce::dsp::Convolution::NonUniform{ non_uniform_head_size }, queue);
+}
+
+void LinearPhaseFilter::prepare(const juce::dsp::ProcessSpec& spec, int kernel_length, convolution_partitioning partitioning)
+{
+    const juce::ScopedLock lock(engine_lock);
+    sample_rate = spec.sampleRate;
+    current_kernel_length = kernel_length;
+
+    double designed_sample_rate = 0.0;
+    loaded_generation = designer.get_generation();
+    auto kernel = design_kernel(designer.get_coefficients(designed_sample_rate), kernel_length);
+
+    convolutions.clear();
+    conversion_buffer.setSize((int)spec.numChannels, (int)spec.maximumBlockSize);
+
+    if (!shared_queue)
+        shared_queue.emplace();
+    const juce::ScopedLock push_lock((*shared_queue)->push_lock);
+
+    for (juce::uint32 channel = 0; channel < spec.numChannels; channel += 2)
+    {
+        auto* convolution = convolutions.add(create_convolution(partitioning, (*shared_queue)->queue));
+
+        // Loaded before prepare, so the first block already runs with it
+        convolution->loadImpulseResponse(juce::AudioBuffer<float>(kernel), sample_rate, juce::dsp::Convolution::Stereo::no,
+                                         juce::dsp::Convolution::Trim::no, juce::dsp::Convolution::Normalise::no);
+        convolution->prepare({ spec.sampleRate, spec.maximumBlockSize, juce::jmin(2u, spec.numChannels - channel) });
+    }
+}
+
+void LinearPhaseFilter::release()
+{
+    const juce::ScopedLock lock(engine_lock);
+    convolutions.clear();
+    conversion_buffer.setSize(0, 0);
+    current_kernel_length = 0;
+    shared_queue.reset();
+}
+
+void LinearPhaseFilter::reset() noexcept
+{
+    for (auto* convolution : convolutions)
+        convolution->reset();
+}
+
+int LinearPhaseFilter::get_latency_samples() const noexcept
+{
+    auto engine_latency = convolutions.isEmpty() ? 0 : convolutions.getFirst()->getLatency();
+    return current_kernel_length / 2 + engine_latency;
+}
+
+int LinearPhaseFilter::get_tail_samples() const noexcept
+{
+    return get_latency_samples() + current_kernel_length / 2;
+}
+
+void LinearPhaseFilter::process(const juce::dsp::AudioBlock<float>& block) noexcept
+{
+    for (int pair = 0; pair < convolutions.size(); ++pair)
+    {
+        auto first_channel = (size_t)pair * 2;
+        if (first_channel >= block.getNumChannels())
+            break;
+
+        auto channels = block.getSubsetChannelBlock(first_channel, juce::jmin((size_t)2, block.getNumChannels() - first_channel));
+        juce::dsp::ProcessContextReplacing<float> context(channels);
+        convolutions.getUnchecked(pair)->process(context);
+    }
+}
+
+void LinearPhaseFilter::process(const juce::dsp::AudioBlock<double>& block) noexcept
+{
+    auto num_channels = juce::jmin(block.getNumChannels(), (size_t)conversion_buffer.getNumChannels());
+    auto max_samples = (size_t)conversion_buffer.getNumSamples();
+    if (max_samples == 0)
+        return;
+
+    for (size_t start = 0; start < block.getNumSamples(); start += max_samples)
+    {
+        auto num_samples = juce::jmin(max_samples, block.getNumSamples() - start);
+        juce::dsp::AudioBlock<float> converted(conversion_buffer.getArrayOfWritePointers(), num_channels, num_samples);
+
+        for (size_t channel = 0; channel < num_channels; ++channel)
+        {
+            auto* source = block.getChannelPointer(channel) + start;
+            auto* destination = converted.getChannelPointer(channel);
+            for (size_t i = 0; i < num_samples; ++i)
+                destination[i] = (float)source[i];
+        }
+
+        process(converted);
+
+        for (size_t channel = 0; channel < num_channels; ++channel)
+        {
+            auto* source = converted.getChannelPointer(channel);
+            auto* destination = block.getChannelPointer(channel) + start;
+            for (size_t i = 0; i < num_samples; ++i)
+                destination[i] = (double)source[i];
+        }
+    }
+}
+
+void LinearPhaseFilter::load_kernel(const juce::AudioBuffer<float>& kernel)
+{
+    // The engines swap the new kernel in on their own thread and crossfade to it
+    const juce::ScopedLock push_lock((*shared_queue)->push_lock);
+    for (auto* convolution : convolutions)
+        convolution->loadImpulseResponse(juce::AudioBuffer<float>(kernel), sample_rate, juce::dsp::Convolution::Stereo::no,
+                                         juce::dsp::Convolution::Trim::no, juce::dsp::Convolution::Normalise::no);
+}
+
+int LinearPhaseFilter::useTimeSlice()
+{
+    const juce::ScopedLock lock(engine_lock);
+    if (convolutions.isEmpty() || designer.get_generation() == loaded_generation)
+        return 50;
+
+    double designed_sample_rate = 0.0;
+    loaded_generation = designer.get_generation();
+    auto coefficient_set = designer.get_coefficients(designed_sample_rate);
+    if (designed_sample_rate == sample_rate)
+        load_kernel(design_kernel(coefficient_set, current_kernel_length));
+
+    // Rebuilding a long kernel is far heavier than a biquad, so don't chase every slider step
+    return 50;
+}
@@ -0,0 +1,86 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Linear phase version of the chain.
+
+    The magnitude response of the designed sections is sampled on an FFT
+    grid, given zero phase, transformed back and windowed into a symmetric
+    FIR of kernel_length taps centred on kernel_length / 2. It's applied
+    with juce::dsp::Convolution, which partitions the kernel (non-uniformly
+    for zero added latency, uniformly for less CPU) and crossfades to a new
+    kernel on its own background thread. Kernels are rebuilt on the shared
+    design thread whenever the designer publishes a new coefficient set.
+
+    juce::dsp::Convolution only runs in float, so double blocks go through
+    a float copy. A FIR doesn't need the extra precision that the steep IIR
+    cascades do.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterDesigner.h"
+
+// How the kernel is partitioned, chosen per session
+enum class convolution_partitioning
+{
+    zero_latency,
+    low_cpu
+};
+
+class LinearPhaseFilter : private juce::TimeSliceClient
+{
+public:
+    explicit LinearPhaseFilter(const FilterDesigner&);
+    ~LinearPhaseFilter() override;
+
+    // Not realtime safe: builds the convolution engines with the current kernel
+    void prepare(const juce::dsp::ProcessSpec&, int kernel_length, convolution_partitioning);
+    void release();
+    void reset() noexcept;
+
+    void process(const juce::dsp::AudioBlock<float>&) noexcept;
+    void process(const juce::dsp::AudioBlock<double>&) noexcept;
+
+    // The kernel's centre plus whatever the partitioning adds
+    int get_latency_samples() const noexcept;
+
+    // The latency plus the other half of the kernel
+    int get_tail_samples() const noexcept;
+
+    static juce::AudioBuffer<float> design_kernel(const CoefficientSet&, int kernel_length);
+    static std::unique_ptr<juce::dsp::Convolution> create_convolution(convolution_partitioning, juce::dsp::ConvolutionMessageQueue&);
+
+    static constexpr int non_uniform_head_size = 256, uniform_partition_size = 1024;
+
+private:
+    int useTimeSlice() override;
+    void load_kernel(const juce::AudioBuffer<float>&);
+
+    const FilterDesigner& designer;
+    juce::SharedResourcePointer<FilterDesigner::DesignThread> design_thread;
+
+    // The background queue the engines load kernels through, shared by every instance in
+    // linear phase. Its thread starts with the first of them and stops with the last.
+    // Pushing to it isn't safe from two threads at once, so loads hold push_lock
+    struct SharedQueue
+    {
+        juce::dsp::ConvolutionMessageQueue queue;
+        juce::CriticalSection push_lock;
+    };
+    std::optional<juce::SharedResourcePointer<SharedQueue>> shared_queue;
+
+    // One engine per channel pair, declared after the queue so they're gone before it is
+    juce::OwnedArray<juce::dsp::Convolution> convolutions;
+    juce::AudioBuffer<float> conversion_buffer;
+
+    juce::CriticalSection engine_lock;
+    double sample_rate{ 0.0 };
+    int current_kernel_length{ 0 };
+    juce::uint32 loaded_generation{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LinearPhaseFilter)
+};
@@ -0,0 +1,183 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    The low cut at a fraction of the sample rate, for 88.2 kHz and up.
+
+  ==============================================================================
+*/
+
+#include "MultirateLowCut.h"
+
+template <typename SampleType>
+int MultirateLowCut<SampleType>::get_num_stages(double sample_rate) noexcept
+{
+    int stages = 0;
+    while (stages < max_stages && sample_rate >= 88200.0)
+    {
+        sample_rate *= 0.5;
+        ++stages;
+    }
+    return stages;
+}
+
+template <typename SampleType>
+MultirateLowCut<SampleType>::MultirateLowCut()
+{
+    // Windowed sinc at half the Nyquist. With Kaiser beta 10 the ripple, which is also how
+    // far the low cut can pull anything down, sits around -95 dB
+    std::array<double, half_band_length> window;
+    juce::dsp::WindowingFunction<double>::fillWindowingTables(window.data(), (size_t)half_band_length,
+                                                              juce::dsp::WindowingFunction<double>::kaiser, false, 10.0);
+    for (int i = 0; i < num_taps; ++i)
+    {
+        auto offset = (double)(2 * i - centre);
+        auto tap = std::sin(juce::MathConstants<double>::halfPi * offset) / (juce::MathConstants<double>::pi * offset);
+        half_band[(size_t)i] = simd_type::expand((SampleType)(tap * window[(size_t)(2 * i)]));
+    }
+}
+
+template <typename SampleType>
+void MultirateLowCut<SampleType>::prepare(double sample_rate, size_t num_groups)
+{
+    num_stages = get_num_stages(sample_rate);
+    decimated_rate = std::ldexp(sample_rate, -num_stages);
+
+    // Every stage's round trip is twice the half band's delay at its own input rate
+    latency_samples = 2 * centre * ((1 << num_stages) - 1);
+    jassert(latency_samples < delay_size);
+
+    groups.resize(is_active() ? num_groups : 0);
+    last_frequency = -1.f;
+    num_sections = 0;
+    reset();
+}
+
+template <typename SampleType>
+void MultirateLowCut<SampleType>::release()
+{
+    num_stages = latency_samples = num_sections = 0;
+    groups.clear();
+}
+
+template <typename SampleType>
+void MultirateLowCut<SampleType>::reset() noexcept
+{
+    const simd_type zero((SampleType)0);
+    for (auto& group : groups)
+    {
+        for (auto& stage : group.stages)
+        {
+            stage.input.fill(zero);
+            stage.output.fill(zero);
+            stage.input_position = stage.output_position = 0;
+            stage.has_half_pair = false;
+            stage.pending = zero;
+        }
+        group.s1.fill(zero);
+        group.s2.fill(zero);
+        group.delay.fill(zero);
+        group.delay_position = 0;
+    }
+}
+
+template <typename SampleType>
+void MultirateLowCut<SampleType>::update(design_mode mode, float frequency, slope cut_slope) noexcept
+{
+    if (!is_active() || (mode == last_mode && frequency == last_frequency && cut_slope == last_slope))
+        return;
+
+    last_mode = mode;
+    last_frequency = frequency;
+    last_slope = cut_slope;
+
+    std::array<BiquadCoefficients, max_sections> sections;
+    auto new_num_sections = coefficient_cache->get_cut_filter(mode, cut_type::high_pass, decimated_rate, frequency, cut_slope, sections.data());
+    for (int i = 0; i < new_num_sections; ++i)
+    {
+        auto& section = sections[(size_t)i];
+        b0[(size_t)i] = simd_type::expand((SampleType)section.b0);
+        b1[(size_t)i] = simd_type::expand((SampleType)section.b1);
+        b2[(size_t)i] = simd_type::expand((SampleType)section.b2);
+        a1[(size_t)i] = simd_type::expand((SampleType)section.a1);
+        a2[(size_t)i] = simd_type::expand((SampleType)section.a2);
+    }
+
+    // Sections added by a steeper slope start from silence
+    for (auto& group : groups)
+        for (int i = num_sections; i < new_num_sections; ++i)
+            group.s1[(size_t)i] = group.s2[(size_t)i] = simd_type((SampleType)0);
+    num_sections = new_num_sections;
+}
+
+template <typename SampleType>
+void MultirateLowCut<SampleType>::process(simd_type* lanes, size_t num_samples, size_t group_index) noexcept
+{
+    auto& group = groups[group_index];
+    const auto mask = delay_size - 1;
+
+    for (size_t n = 0; n < num_samples; ++n)
+    {
+        auto input = lanes[n];
+        auto removed = process_stage(group, 0, input);
+
+        group.delay[(size_t)group.delay_position] = input;
+        auto delayed = group.delay[(size_t)((group.delay_position - latency_samples) & mask)];
+        group.delay_position = (group.delay_position + 1) & mask;
+
+        lanes[n] = delayed - removed;
+    }
+}
+
+template <typename SampleType>
+auto MultirateLowCut<SampleType>::process_stage(Group& group, int index, simd_type input) noexcept -> simd_type
+{
+    auto& stage = group.stages[(size_t)index];
+    stage.input[(size_t)stage.input_position] = stage.input[(size_t)(stage.input_position + half_band_length)] = input;
+    stage.input_position = (stage.input_position + 1) % half_band_length;
+
+    // Every other sample only hands out the second half of the last interpolated pair
+    stage.has_half_pair = !stage.has_half_pair;
+    if (stage.has_half_pair)
+        return stage.pending;
+
+    // Decimate: oldest sample first, the centre tap is 0.5 and the even offsets are zero
+    const auto* x = stage.input.data() + stage.input_position;
+    auto decimated = x[centre] * (SampleType)0.5;
+    for (int i = 0; i < num_taps; ++i)
+        decimated += half_band[(size_t)i] * (x[2 * i] + x[half_band_length - 1 - 2 * i]);
+
+    auto low = index + 1 < num_stages ? process_stage(group, index + 1, decimated) : process_low_cut(group, decimated);
+
+    // Interpolate: the even output runs the outer taps at twice the gain, the odd one is the centre
+    const int output_length = 2 * num_taps;
+    stage.output[(size_t)stage.output_position] = stage.output[(size_t)(stage.output_position + output_length)] = low;
+    stage.output_position = (stage.output_position + 1) % output_length;
+
+    const auto* u = stage.output.data() + stage.output_position;
+    simd_type even((SampleType)0);
+    for (int i = 0; i < num_taps; ++i)
+        even += half_band[(size_t)i] * (u[output_length - 1 - i] + u[i]);
+
+    stage.pending = u[num_taps];
+    return even * (SampleType)2;
+}
+
+template <typename SampleType>
+auto MultirateLowCut<SampleType>::process_low_cut(Group& group, simd_type input) noexcept -> simd_type
+{
+    // Transposed direct form II like the chain, returning only what the low cut removes
+    auto x = input;
+    for (int i = 0; i < num_sections; ++i)
+    {
+        auto index = (size_t)i;
+        auto y = b0[index] * x + group.s1[index];
+        group.s1[index] = b1[index] * x - a1[index] * y + group.s2[index];
+        group.s2[index] = b2[index] * x - a2[index] * y;
+        x = y;
+    }
+    return input - x;
+}
+
+template class MultirateLowCut<float>;
+template class MultirateLowCut<double>;
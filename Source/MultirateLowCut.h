@@ -0,0 +1,100 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    The low cut at a fraction of the sample rate, for 88.2 kHz and up.
+
+    A 20 Hz Butterworth at 192 kHz puts its poles so close to z = 1 that
+    float coefficients can't place them, the response is off by several dB
+    around the corner. Everything the low cut does happens far below the
+    decimated Nyquist, so the signal is split instead:
+
+        y = delay(x) - interpolate(r),  r = d - low_cut(d),  d = decimate(x)
+
+    r is what the low cut takes away, computed at 44.1 or 48 kHz where the
+    same design is well conditioned. Each halving is a linear phase half
+    band FIR run polyphase, so only every other input sample is filtered
+    and every other tap is zero, and the direct path is delayed by exactly
+    the round trip: 30 samples at 96 kHz, 90 at 192 kHz. Half band ripple
+    and aliasing only touch r, which is small everywhere but the bottom
+    octaves. The price is a floor: nothing is attenuated by more than the
+    ripple, around 95 dB.
+
+    Runs on the interleaved lanes of SIMDFilterChain, each group of channels
+    with its own state.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "CoefficientCache.h"
+
+template <typename SampleType>
+class MultirateLowCut
+{
+public:
+    using simd_type = juce::dsp::SIMDRegister<SampleType>;
+
+    // Halvings until the rate is below 88.2 kHz: none at 48 kHz, one at 96 kHz, two at 192 kHz
+    static int get_num_stages(double sample_rate) noexcept;
+
+    MultirateLowCut();
+
+    void prepare(double sample_rate, size_t num_groups);
+    void release();
+    void reset() noexcept;
+
+    bool is_active() const noexcept { return num_stages > 0; }
+    int get_latency_samples() const noexcept { return latency_samples; }
+
+    // Audio thread: redesigns at the decimated rate when the low cut changed, through the
+    // shared cache, so this is a compare on most blocks and a table lookup on the others
+    void update(design_mode, float frequency, slope) noexcept;
+
+    // One group of interleaved channels, in place
+    void process(simd_type* lanes, size_t num_samples, size_t group) noexcept;
+
+private:
+    // Half band of 4 * num_taps - 1 taps, num_taps of them distinct and non-zero besides the centre
+    static constexpr int num_taps = 8, half_band_length = 4 * num_taps - 1, centre = 2 * num_taps - 1;
+    static constexpr int max_stages = 3, max_sections = 4, delay_size = 256;
+
+    struct Stage
+    {
+        // Both histories are written twice, so the taps always read one contiguous run
+        std::array<simd_type, 2 * half_band_length> input;
+        std::array<simd_type, 4 * num_taps> output;
+        int input_position{ 0 }, output_position{ 0 };
+        bool has_half_pair{ false };
+        simd_type pending;
+    };
+
+    struct Group
+    {
+        std::array<Stage, max_stages> stages;
+        std::array<simd_type, max_sections> s1, s2;
+        std::array<simd_type, delay_size> delay;
+        int delay_position{ 0 };
+    };
+
+    simd_type process_stage(Group&, int index, simd_type input) noexcept;
+    simd_type process_low_cut(Group&, simd_type input) noexcept;
+
+    std::array<simd_type, num_taps> half_band;
+    int num_stages{ 0 }, latency_samples{ 0 };
+    double decimated_rate{ 0.0 };
+    std::vector<Group> groups;
+
+    std::array<simd_type, max_sections> b0, b1, b2, a1, a2;
+    int num_sections{ 0 };
+    design_mode last_mode{ design_mode::bilinear };
+    float last_frequency{ -1.f };
+    slope last_slope{ slope::slope_12 };
+
+    juce::SharedResourcePointer<CoefficientCache> coefficient_cache;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MultirateLowCut)
+};
@@ -19,16 +19,46 @@ SEQAudioProcessorEditor::SEQAudioProcessorEditor (SEQAudioProcessor& p)
     low_cut_freq_slider_attachment(audioProcessor.audio_processor_value_tree_state,LOW_CUT_FREQ,low_cut_freq_slider),
     high_cut_freq_slider_attachment(audioProcessor.audio_processor_value_tree_state,HIGH_CUT_FREQ,high_cut_freq_slider),
     low_cut_slope_slider_attachment(audioProcessor.audio_processor_value_tree_state,LOW_CUT_SLOPE,low_cut_slope_slider),
-    high_cut_slope_slider_attachment(audioProcessor.audio_processor_value_tree_state,HIGH_CUT_SLOPE,high_cut_slope_slider)
+    high_cut_slope_slider_attachment(audioProcessor.audio_processor_value_tree_state,HIGH_CUT_SLOPE,high_cut_slope_slider),
+    spectrum_analyser_component(audioProcessor.get_spectrum_analyser()),
+    response_curve_component(audioProcessor.get_filter_designer()),
+    stage_profiler_component(audioProcessor.get_stage_profiler())
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
 
-    /*TODO : (0). Connect the sliders to parameters*/
     for (auto* component : get_components())
     {
         addAndMakeVisible(component);
     };
+    addAndMakeVisible(spectrum_analyser_component);
+    addAndMakeVisible(response_curve_component);
+    addAndMakeVisible(stage_profiler_component);
+
+    for (int i = 0; i < audioProcessor.getNumPrograms(); ++i)
+        snapshot_selector.addItem(audioProcessor.getProgramName(i), i + 1);
+    snapshot_selector.setSelectedId(audioProcessor.getCurrentProgram() + 1, juce::dontSendNotification);
+    snapshot_selector.onChange = [this] { audioProcessor.setCurrentProgram(snapshot_selector.getSelectedId() - 1); };
+    store_snapshot_button.onClick = [this] { audioProcessor.store_snapshot(snapshot_selector.getSelectedId() - 1); };
+    addAndMakeVisible(snapshot_selector);
+    addAndMakeVisible(store_snapshot_button);
+
+    profile_button.setToggleState(audioProcessor.get_stage_profiler().is_enabled(), juce::dontSendNotification);
+    profile_button.onClick = [this] { audioProcessor.get_stage_profiler().set_enabled(profile_button.getToggleState()); };
+    save_trace_button.onClick = [this]
+    {
+        trace_chooser = std::make_unique<juce::FileChooser>("Save Profiler Trace",
+            juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("SEQ Trace.csv"), "*.csv");
+        trace_chooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles | juce::FileBrowserComponent::warnAboutOverwriting,
+            [this](const juce::FileChooser& chooser)
+            {
+                auto file = chooser.getResult();
+                if (file != juce::File())
+                    audioProcessor.get_stage_profiler().write_csv(file, StageProfilerComponent::trace_seconds);
+            });
+    };
+    addAndMakeVisible(profile_button);
+    addAndMakeVisible(save_trace_button);
 
     setSize (800, 600);
 }
@@ -54,7 +84,15 @@ void SEQAudioProcessorEditor::resized()
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
     auto bound = getLocalBounds();
+    auto snapshot_area = bound.removeFromTop(24);
+    store_snapshot_button.setBounds(snapshot_area.removeFromRight(60));
+    snapshot_selector.setBounds(snapshot_area.removeFromRight(160));
+    profile_button.setBounds(snapshot_area.removeFromLeft(80));
+    save_trace_button.setBounds(snapshot_area.removeFromLeft(90));
     auto response_area = bound.removeFromTop(bound.getHeight() * 0.33);
+    spectrum_analyser_component.setBounds(response_area);
+    response_curve_component.setBounds(response_area);
+    stage_profiler_component.setBounds(response_area);
     auto low_cut_area = bound.removeFromLeft(bound.getWidth() * 0.33);
     auto high_cut_area = bound.removeFromRight(bound.getWidth() * 0.5);
     low_cut_freq_slider.setBounds(low_cut_area.removeFromTop(low_cut_area.getHeight()*0.5));
@@ -11,6 +11,9 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "SpectrumAnalyserComponent.h"
+#include "ResponseCurveComponent.h"
+#include "StageProfilerComponent.h"
 
 
 
@@ -46,5 +49,19 @@ private:
 
     juce::AudioProcessorValueTreeState::SliderAttachment peak_freq_slider_attachment, peak_gain_slider_attachment, peak_quality_slider_attachment, low_cut_freq_slider_attachment, high_cut_freq_slider_attachment, low_cut_slope_slider_attachment, high_cut_slope_slider_attachment;
 
+    // Recalls a program, Store writes the current settings into the selected one
+    juce::ComboBox snapshot_selector;
+    juce::TextButton store_snapshot_button{ "Store" };
+
+    // Drawn in the response area, analysis only runs while this editor is open
+    SpectrumAnalyserComponent spectrum_analyser_component;
+    ResponseCurveComponent response_curve_component;
+
+    // Profiling stays on after the editor closes, so a trace can cover a session without it
+    juce::ToggleButton profile_button{ "Profile" };
+    juce::TextButton save_trace_button{ "Save Trace" };
+    std::unique_ptr<juce::FileChooser> trace_chooser;
+    StageProfilerComponent stage_profiler_component;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SEQAudioProcessorEditor)
 };
@@ -11,6 +11,10 @@
 #include "PluginEditor.h"
 
 
+// Parameters that change the latency. Their listener only raises a flag, since hosts can
+// automate them from the audio thread, see timerCallback
+static const char* const latency_parameter_ids[] = { PHASE_MODE, LINEAR_PHASE_LENGTH, LINEAR_PHASE_PARTITIONING, LOW_CUT_MODE };
+
 //==============================================================================
 SEQAudioProcessor::SEQAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -18,16 +22,31 @@ SEQAudioProcessor::SEQAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        )
 #endif
 {
+    chain_parameters.attach(audio_processor_value_tree_state);
+    smoothing_parameter = audio_processor_value_tree_state.getRawParameterValue(SMOOTHING);
+    topology_parameter = audio_processor_value_tree_state.getRawParameterValue(FILTER_TOPOLOGY);
+    morph_parameter = audio_processor_value_tree_state.getRawParameterValue(MORPH);
+    morph_target_parameter = audio_processor_value_tree_state.getRawParameterValue(MORPH_TARGET);
+    dynamic_parameters.attach(audio_processor_value_tree_state);
+    snapshot_bank.initialise(chain_parameters.load());
+
+    for (auto* parameter_id : latency_parameter_ids)
+        audio_processor_value_tree_state.addParameterListener(parameter_id, this);
+    startTimer(50);
 }
 
 SEQAudioProcessor::~SEQAudioProcessor()
 {
+    for (auto* parameter_id : latency_parameter_ids)
+        audio_processor_value_tree_state.removeParameterListener(parameter_id, this);
+    stopTimer();
 }
 
 //==============================================================================
@@ -65,31 +84,62 @@ bool SEQAudioProcessor::isMidiEffect() const
 
 double SEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    auto sample_rate = getSampleRate();
+    return sample_rate > 0.0 ? get_tail_samples() / sample_rate : 0.0;
+}
+
+int SEQAudioProcessor::get_tail_samples() const noexcept
+{
+    // Whichever chain is running, measured from its actual poles or kernel
+    return use_linear_phase ? linear_phase_filter.get_tail_samples() : filter_designer.get_tail_samples() + getLatencySamples();
 }
 
 int SEQAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return SnapshotBank::num_snapshots;
 }
 
 int SEQAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return current_program.load();
 }
 
 void SEQAudioProcessor::setCurrentProgram (int index)
 {
+    if (!juce::isPositiveAndBelow(index, SnapshotBank::num_snapshots))
+        return;
+
+    // Hosts may call this from the audio thread. Only fixed size copies and the publish happen
+    // here, the snapshot was designed when it was stored. Writing its settings to the parameters
+    // calls back into the host, so that's left to the timer
+    ChainSettings chain_settings;
+    CoefficientSet coefficient_set;
+    double sample_rate{ 0.0 };
+    snapshot_bank.get(index, chain_settings, coefficient_set, sample_rate);
+    filter_designer.recall(chain_settings, coefficient_set, sample_rate);
+    current_program = index;
+    recalled_program = index;
 }
 
 const juce::String SEQAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return snapshot_bank.get_name(index);
 }
 
 void SEQAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    snapshot_bank.set_name(index, newName);
+    updateHostDisplay();
+}
+
+void SEQAudioProcessor::store_snapshot(int index)
+{
+    if (!juce::isPositiveAndBelow(index, SnapshotBank::num_snapshots))
+        return;
+
+    snapshot_bank.store(index, chain_parameters.load());
+    current_program = index;
+    updateHostDisplay();
 }
 
 //==============================================================================
@@ -100,116 +150,115 @@ void SEQAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 
     juce::dsp::ProcessSpec spec;
     spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
+    spec.numChannels = (juce::uint32)getTotalNumOutputChannels();
     spec.sampleRate = sampleRate;
-    left_chain.prepare(spec);
-    right_chain.prepare(spec);
-    auto chain_settings = get_chain_settings(this->audio_processor_value_tree_state);
-    auto peak_coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,chain_settings.peak_freq,chain_settings.peak_quality,juce::Decibels::decibelsToGain(chain_settings.peak_gain_in_decibels));
-    *left_chain.get<(int)chain_positions::peak>().coefficients = *peak_coefficients;
-    *right_chain.get<(int)chain_positions::peak>().coefficients = *peak_coefficients;
-
-    auto cut_coefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chain_settings.low_cut_freq,sampleRate,2*((int)chain_settings.low_cut_slope+1));
-    auto& left_low_cut = left_chain.get<(int)chain_positions::low_cut>();
-
-    /*TODO : (1). high cut parameters coefficient needs to be implemented*/
-    /*TODO : (2). code refactoring needs to be done!*/
-    /*TODO : (3). GUI Implementation needs to be done!*/
-    /*TODO : And that's it for this project*/
-
-    left_low_cut.setBypassed<0>(true);
-    left_low_cut.setBypassed<1>(true);
-    left_low_cut.setBypassed<2>(true);
-    left_low_cut.setBypassed<3>(true);
-    switch (chain_settings.low_cut_slope)
-    {
-    case slope::slope_12:
-    {
-        *left_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        left_low_cut.setBypassed<0>(false);
-        break;
-    };
-    case slope::slope_24:
+    auto latency_settings = get_latency_settings();
+    use_linear_phase = latency_settings.linear_phase;
+    use_multirate_low_cut = latency_settings.multirate_low_cut;
+
+    int iir_latency = 0;
+    auto prepare_chains = [&](auto& chains)
     {
-        *left_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        left_low_cut.setBypassed<0>(false);
-        *left_low_cut.get<1>().coefficients = *cut_coefficients[1];
-        left_low_cut.setBypassed<1>(false);
-        break;
+        auto chain_settings = chain_parameters.load();
+        chains.biquad.prepare(spec, use_multirate_low_cut);
+        chains.biquad.update_low_cut(chain_settings.filter_design, chain_settings.low_cut_freq, chain_settings.low_cut_slope);
+        chains.state_variable.prepare(spec);
+        chains.state_variable.update(design_svf(chain_settings, sampleRate));
+
+        iir_latency = chains.biquad.get_latency_samples();
+        chains.state_variable_delay.prepare(spec);
+        chains.state_variable_delay.setMaximumDelayInSamples(juce::jmax(1, iir_latency));
+        chains.state_variable_delay.setDelay((float)iir_latency);
     };
-    case slope::slope_36:
-    {
-        *left_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        left_low_cut.setBypassed<0>(false);
-        *left_low_cut.get<1>().coefficients = *cut_coefficients[1];
-        left_low_cut.setBypassed<1>(false);
-        *left_low_cut.get<2>().coefficients = *cut_coefficients[2];
-        left_low_cut.setBypassed<2>(false);
-        break;
 
-    };
-    case slope::slope_48:
-    {
-        *left_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        left_low_cut.setBypassed<0>(false);
-        *left_low_cut.get<1>().coefficients = *cut_coefficients[1];
-        left_low_cut.setBypassed<1>(false);
-        *left_low_cut.get<2>().coefficients = *cut_coefficients[2];
-        left_low_cut.setBypassed<2>(false);
-        *left_low_cut.get<3>().coefficients = *cut_coefficients[3];
-        left_low_cut.setBypassed<3>(false);
-        break;
-    };
+    // Design right away so the first block already runs with the current settings
+    filter_designer.prepare(sampleRate);
+    if (isUsingDoublePrecision())
+    {
+        prepare_chains(double_chains);
+        update_filters<double>();
     }
-
-    auto& right_low_cut = right_chain.get<(int)chain_positions::low_cut>();
-
-    right_low_cut.setBypassed<0>(true);
-    right_low_cut.setBypassed<1>(true);
-    right_low_cut.setBypassed<2>(true);
-    right_low_cut.setBypassed<3>(true);
-    switch (chain_settings.low_cut_slope)
+    else
     {
-    case slope::slope_12:
+        prepare_chains(float_chains);
+        update_filters<float>();
+    }
+    coefficient_smoother.prepare(sampleRate, chain_parameters.load());
+    snapshot_bank.prepare(sampleRate);
+    morph_amount.reset(sampleRate, 0.05);
+    morph_amount.setCurrentAndTargetValue(morph_parameter->load());
+    morphing = false;
+    dynamic_band.prepare(sampleRate);
+    spectrum_analyser.prepare(sampleRate, samplesPerBlock);
+
+    if (use_linear_phase)
     {
-        *right_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        right_low_cut.setBypassed<0>(false);
-        break;
-    };
-    case slope::slope_24:
+        linear_phase_filter.prepare(spec, latency_settings.kernel_length, latency_settings.partitioning);
+        setLatencySamples(linear_phase_filter.get_latency_samples());
+    }
+    else
     {
-        *right_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        right_low_cut.setBypassed<0>(false);
-        *right_low_cut.get<1>().coefficients = *cut_coefficients[1];
-        right_low_cut.setBypassed<1>(false);
-        break;
-    };
-    case slope::slope_36:
+        linear_phase_filter.release();
+        setLatencySamples(iir_latency);
+    }
+    prepared_latency_settings = latency_settings;
+
+    silence_detector.reset();
+};
+
+
+SEQAudioProcessor::LatencySettings SEQAudioProcessor::get_latency_settings() const noexcept
+{
+    // Kernel length and partitioning only count in linear phase and Low Cut Mode only
+    // outside it, moving the others changes nothing
+    LatencySettings settings;
+    settings.linear_phase = audio_processor_value_tree_state.getRawParameterValue(PHASE_MODE)->load() > 0.5f;
+    if (settings.linear_phase)
     {
-        *right_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        right_low_cut.setBypassed<0>(false);
-        *right_low_cut.get<1>().coefficients = *cut_coefficients[1];
-        right_low_cut.setBypassed<1>(false);
-        *right_low_cut.get<2>().coefficients = *cut_coefficients[2];
-        right_low_cut.setBypassed<2>(false);
-        break;
+        static constexpr int kernel_lengths[] = { 4096, 8192, 16384 };
+        settings.kernel_length = kernel_lengths[juce::jlimit(0, 2, (int)audio_processor_value_tree_state.getRawParameterValue(LINEAR_PHASE_LENGTH)->load())];
+        settings.partitioning = static_cast<convolution_partitioning>(audio_processor_value_tree_state.getRawParameterValue(LINEAR_PHASE_PARTITIONING)->load());
+    }
+    else
+    {
+        settings.multirate_low_cut = audio_processor_value_tree_state.getRawParameterValue(LOW_CUT_MODE)->load() > 0.5f;
+    }
+    return settings;
+}
 
-    };
-    case slope::slope_48:
-    {
-        *right_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        right_low_cut.setBypassed<0>(false);
-        *right_low_cut.get<1>().coefficients = *cut_coefficients[1];
-        right_low_cut.setBypassed<1>(false);
-        *right_low_cut.get<2>().coefficients = *cut_coefficients[2];
-        right_low_cut.setBypassed<2>(false);
-        *right_low_cut.get<3>().coefficients = *cut_coefficients[3];
-        right_low_cut.setBypassed<3>(false);
-        break;
-    };
+// Any thread, automation can come from the audio thread, so nothing here may lock or allocate
+void SEQAudioProcessor::parameterChanged(const juce::String&, float)
+{
+    latency_change_pending = true;
+}
+
+void SEQAudioProcessor::timerCallback()
+{
+    if (auto program = recalled_program.exchange(-1); program >= 0)
+    {
+        ChainSettings chain_settings;
+        CoefficientSet coefficient_set;
+        double sample_rate{ 0.0 };
+        snapshot_bank.get(program, chain_settings, coefficient_set, sample_rate);
+        set_chain_settings(audio_processor_value_tree_state, chain_settings);
+
+        // The new values are a jump to the recalled set, not automation to ramp through
+        snap_smoother_pending = true;
     }
-};
 
+    if (!latency_change_pending.exchange(false))
+        return;
+
+    // Before the first prepareToPlay there's nothing to redo, it reads the parameters itself
+    if (getSampleRate() <= 0.0 || getBlockSize() <= 0 || get_latency_settings() == prepared_latency_settings)
+        return;
+
+    // suspendProcessing takes the callback lock, so no block runs while the chains are rebuilt.
+    // setLatencySamples reports the change to the host through updateHostDisplay
+    suspendProcessing(true);
+    prepareToPlay(getSampleRate(), getBlockSize());
+    suspendProcessing(false);
+}
 
 void SEQAudioProcessor::releaseResources()
 {
@@ -224,43 +273,164 @@ bool SEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) cons
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout from mono up to 16 channels (7.1.4, 5.1, discrete...) works,
+    // all channels share the same settings and are packed into SIMD lanes.
+    auto main_output = layouts.getMainOutputChannelSet();
+    if (main_output.isDisabled() || main_output.size() > SIMDFilterChain<float>::max_channels)
         return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // The sidechain only feeds the dynamic band's detector, it can be off, mono or stereo
+    if (layouts.inputBuses.size() > 1)
+    {
+        auto sidechain = layouts.getChannelSet(true, 1);
+        if (!sidechain.isDisabled() && sidechain != juce::AudioChannelSet::mono() && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
    #endif
 
     return true;
   #endif
 }
 #endif
-struct ChainSettings get_chain_settings(juce::AudioProcessorValueTreeState&_audio_processor_value_tree_state)
+void set_chain_settings(juce::AudioProcessorValueTreeState& _audio_processor_value_tree_state, const ChainSettings& setting)
 {
-    ChainSettings setting;
-    setting.low_cut_freq = _audio_processor_value_tree_state.getRawParameterValue(LOW_CUT_FREQ)->load();
-    setting.high_cut_freq= _audio_processor_value_tree_state.getRawParameterValue(HIGH_CUT_FREQ)->load();
-    //continue fill the struct
-    //...
-    setting.peak_freq= _audio_processor_value_tree_state.getRawParameterValue(PEAK_FREQ)->load();
-    setting.peak_gain_in_decibels= _audio_processor_value_tree_state.getRawParameterValue(PEAK_GAIN)->load();
-    setting.peak_quality= _audio_processor_value_tree_state.getRawParameterValue(PEAK_QUALITY)->load();
-    setting.low_cut_slope= static_cast<slope>(_audio_processor_value_tree_state.getRawParameterValue(LOW_CUT_SLOPE)->load());
-    setting.high_cut_slope=static_cast<slope>(_audio_processor_value_tree_state.getRawParameterValue(HIGH_CUT_SLOPE)->load());
+    auto set = [&_audio_processor_value_tree_state](const juce::String& parameter_id, float value)
+    {
+        auto* parameter = _audio_processor_value_tree_state.getParameter(parameter_id);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    };
+
+    set(LOW_CUT_FREQ, setting.low_cut_freq);
+    set(HIGH_CUT_FREQ, setting.high_cut_freq);
+    for (int band = 0; band < num_bands; ++band)
+    {
+        auto& band_settings = setting.bands[(size_t)band];
+        set(get_band_parameter_id(band, BAND_FREQ), band_settings.freq);
+        set(get_band_parameter_id(band, BAND_GAIN), band_settings.gain_in_decibels);
+        set(get_band_parameter_id(band, BAND_QUALITY), band_settings.quality);
+        set(get_band_parameter_id(band, BAND_TYPE), (float)band_settings.type);
+    }
+    set(LOW_CUT_SLOPE, (float)setting.low_cut_slope);
+    set(HIGH_CUT_SLOPE, (float)setting.high_cut_slope);
+    set(DESIGN_MODE, (float)setting.filter_design);
+}
+
+juce::String get_band_parameter_id(int band, const juce::String& name)
+{
+    return band == 0 ? "Peak " + name : "Band " + juce::String(band + 1) + " " + name;
+}
+
+bool operator==(const BandSettings& lhs, const BandSettings& rhs)
+{
+    return lhs.freq == rhs.freq
+        && lhs.gain_in_decibels == rhs.gain_in_decibels
+        && lhs.quality == rhs.quality
+        && lhs.type == rhs.type
+        && lhs.dynamic == rhs.dynamic;
+}
+
+bool operator==(const ChainSettings& lhs, const ChainSettings& rhs)
+{
+    return lhs.bands == rhs.bands
+        && lhs.low_cut_freq == rhs.low_cut_freq
+        && lhs.high_cut_freq == rhs.high_cut_freq
+        && lhs.low_cut_slope == rhs.low_cut_slope
+        && lhs.high_cut_slope == rhs.high_cut_slope
+        && lhs.filter_design == rhs.filter_design;
+}
+
+bool operator!=(const ChainSettings& lhs, const ChainSettings& rhs)
+{
+    return !(lhs == rhs);
+}
+
+void ChainParameters::attach(juce::AudioProcessorValueTreeState& _audio_processor_value_tree_state)
+{
+    low_cut_freq = _audio_processor_value_tree_state.getRawParameterValue(LOW_CUT_FREQ);
+    high_cut_freq = _audio_processor_value_tree_state.getRawParameterValue(HIGH_CUT_FREQ);
+    for (int band = 0; band < num_bands; ++band)
+    {
+        auto& band_parameters = bands[(size_t)band];
+        band_parameters.freq = _audio_processor_value_tree_state.getRawParameterValue(get_band_parameter_id(band, BAND_FREQ));
+        band_parameters.gain = _audio_processor_value_tree_state.getRawParameterValue(get_band_parameter_id(band, BAND_GAIN));
+        band_parameters.quality = _audio_processor_value_tree_state.getRawParameterValue(get_band_parameter_id(band, BAND_QUALITY));
+        band_parameters.type = _audio_processor_value_tree_state.getRawParameterValue(get_band_parameter_id(band, BAND_TYPE));
+    }
+    low_cut_slope = _audio_processor_value_tree_state.getRawParameterValue(LOW_CUT_SLOPE);
+    high_cut_slope = _audio_processor_value_tree_state.getRawParameterValue(HIGH_CUT_SLOPE);
+    filter_design = _audio_processor_value_tree_state.getRawParameterValue(DESIGN_MODE);
+    dynamic_source = _audio_processor_value_tree_state.getRawParameterValue(DYNAMIC_SOURCE);
+}
 
+ChainSettings ChainParameters::load() const noexcept
+{
+    ChainSettings setting;
+    setting.low_cut_freq = low_cut_freq->load();
+    setting.high_cut_freq = high_cut_freq->load();
+    for (size_t band = 0; band < bands.size(); ++band)
+    {
+        setting.bands[band].freq = bands[band].freq->load();
+        setting.bands[band].gain_in_decibels = bands[band].gain->load();
+        setting.bands[band].quality = bands[band].quality->load();
+        setting.bands[band].type = static_cast<band_type>(bands[band].type->load());
+    }
+    setting.low_cut_slope = static_cast<slope>(low_cut_slope->load());
+    setting.high_cut_slope = static_cast<slope>(high_cut_slope->load());
+    setting.filter_design = static_cast<design_mode>(filter_design->load());
+    setting.bands[0].dynamic = dynamic_source->load() > 0.5f;
     return setting;
-};
+}
 
-void SEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+//==============================================================================
+int SEQAudioProcessor::get_control_rate() const noexcept
+{
+    if (auto samples = control_rate_override.load(); samples >= 0)
+        return samples;
+
+    static constexpr int control_rates[] = { 0, 16, 32, 64 };
+    return control_rates[juce::jlimit(0, 3, (int)smoothing_parameter->load())];
+}
+
+template <typename SampleType>
+void SEQAudioProcessor::update_filters() noexcept
 {
+    if (filter_designer.pull(designed_coefficients))
+    {
+        get_chains<SampleType>().biquad.update(designed_coefficients);
+    }
+}
+
+void SEQAudioProcessor::reset_filters() noexcept
+{
+    float_chains.biquad.reset();
+    float_chains.state_variable.reset();
+    float_chains.state_variable_delay.reset();
+    double_chains.biquad.reset();
+    double_chains.state_variable.reset();
+    double_chains.state_variable_delay.reset();
+    linear_phase_filter.reset();
+    dynamic_band.reset();
+}
+
+bool SEQAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+// Both precisions run the same code, the host's buffer is processed as it comes
+template <typename SampleType>
+void SEQAudioProcessor::process_samples(juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+   #if SEQ_REALTIME_CHECKS
+    RealtimeSafety::ScopedAudioCallback audio_callback;
+   #endif
     juce::ScopedNoDenormals noDenormals;
+    stage_profiler.begin_block();
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -273,114 +443,237 @@ void SEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::Mi
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    auto chain_settings = get_chain_settings(this->audio_processor_value_tree_state);
-    auto peak_coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(), chain_settings.peak_freq, chain_settings.peak_quality, juce::Decibels::decibelsToGain(chain_settings.peak_gain_in_decibels));
-    *left_chain.get<(int)chain_positions::peak>().coefficients = *peak_coefficients;
-    *right_chain.get<(int)chain_positions::peak>().coefficients = *peak_coefficients;
+    auto control_rate = get_control_rate();
+    auto chain_settings = chain_parameters.load();
+    auto dynamic_settings = dynamic_parameters.load();
+    coefficient_smoother.set_target(chain_settings);
+    if (control_rate == 0)
+        coefficient_smoother.snap_to_target();
 
+    // A recalled program jumps straight to its stored set rather than ramping there
+    if (snap_smoother_pending.exchange(false))
+        coefficient_smoother.snap_to_target();
+    stage_profiler.mark(StageProfiler::stage::parameters);
 
-    auto cut_coefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chain_settings.low_cut_freq, getSampleRate(), 2 * ((int)chain_settings.low_cut_slope + 1));
-    auto& left_low_cut = left_chain.get<(int)chain_positions::low_cut>();
+    auto& chains = get_chains<SampleType>();
+    juce::dsp::AudioBlock<SampleType>block(buffer);
+    auto channels = block.getSubsetChannelBlock(0, (size_t)totalNumOutputChannels);
 
-    left_low_cut.setBypassed<0>(true);
-    left_low_cut.setBypassed<1>(true);
-    left_low_cut.setBypassed<2>(true);
-    left_low_cut.setBypassed<3>(true);
-    switch (chain_settings.low_cut_slope)
-    {
-    case slope::slope_12:
+    spectrum_analyser.push_pre(channels);
+
+    if (silence_detector.process_input(channels))
     {
-        *left_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        left_low_cut.setBypassed<0>(false);
-        break;
-    };
-    case slope::slope_24:
+        stage_profiler.mark(StageProfiler::stage::analysis);
+
+        // Asleep: keep the coefficients current so waking up needs nothing but this check
+        update_filters<SampleType>();
+        coefficient_smoother.snap_to_target();
+        stage_profiler.mark(StageProfiler::stage::coefficients);
+
+        channels.clear();
+        spectrum_analyser.push_post(channels);
+        stage_profiler.mark(StageProfiler::stage::analysis);
+        stage_profiler.end_block((int)channels.getNumSamples());
+        return;
+    }
+    stage_profiler.mark(StageProfiler::stage::analysis);
+
+    // Switching topology starts the newly active chain from silence rather than stale state
+    auto topology = static_cast<filter_topology>(topology_parameter->load());
+    if (topology != active_topology)
     {
-        *left_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        left_low_cut.setBypassed<0>(false);
-        *left_low_cut.get<1>().coefficients = *cut_coefficients[1];
-        left_low_cut.setBypassed<1>(false);
-        break;
-    };
-    case slope::slope_36:
+        chains.biquad.reset();
+        chains.state_variable.update(design_svf(chain_settings, getSampleRate()));
+        chains.state_variable.reset();
+        chains.state_variable_delay.reset();
+        active_topology = topology;
+    }
+
+    // Only does anything while Low Cut Mode is multirate, a compare on most blocks
+    chains.biquad.update_low_cut(chain_settings.filter_design, chain_settings.low_cut_freq, chain_settings.low_cut_slope);
+
+    morph_amount.setTargetValue(morph_parameter->load());
+    auto morph_active = morph_amount.isSmoothing() || morph_amount.getTargetValue() > 0.f;
+    if (morphing && !morph_active)
     {
-        *left_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        left_low_cut.setBypassed<0>(false);
-        *left_low_cut.get<1>().coefficients = *cut_coefficients[1];
-        left_low_cut.setBypassed<1>(false);
-        *left_low_cut.get<2>().coefficients = *cut_coefficients[2];
-        left_low_cut.setBypassed<2>(false);
-        break;
+        // Back to what the parameters say, they may have moved on since the program was recalled
+        filter_designer.pull(designed_coefficients);
+        chains.biquad.update(designed_coefficients);
+        morphing = false;
+    }
+    stage_profiler.mark(StageProfiler::stage::coefficients);
 
-    };
-    case slope::slope_48:
-    {
-        *left_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        left_low_cut.setBypassed<0>(false);
-        *left_low_cut.get<1>().coefficients = *cut_coefficients[1];
-        left_low_cut.setBypassed<1>(false);
-        *left_low_cut.get<2>().coefficients = *cut_coefficients[2];
-        left_low_cut.setBypassed<2>(false);
-        *left_low_cut.get<3>().coefficients = *cut_coefficients[3];
-        left_low_cut.setBypassed<3>(false);
-        break;
-    };
+    if (use_linear_phase)
+    {
+        // The kernel follows the designer on the background thread, there's nothing to update here
+        linear_phase_filter.process(channels);
+        stage_profiler.mark(StageProfiler::stage::whole_chain);
+    }
+    else if (topology == filter_topology::state_variable)
+    {
+        process_state_variable(channels, chain_settings, control_rate);
+
+        // The state variable chain keeps its own low cut, it only has to line up with the biquad one
+        if (chains.biquad.is_low_cut_multirate())
+        {
+            juce::dsp::ProcessContextReplacing<SampleType> context(channels);
+            chains.state_variable_delay.process(context);
+            stage_profiler.mark(StageProfiler::stage::whole_chain);
+        }
+    }
+    else if (morph_active)
+    {
+        process_morph(channels, control_rate);
+    }
+    else if (dynamic_settings.source != dynamic_source::off)
+    {
+        // Detected before each sub-block is filtered, so the input source sees the dry signal
+        auto* sidechain_bus = getBus(true, 1);
+        auto use_sidechain = dynamic_settings.source == dynamic_source::sidechain && sidechain_bus != nullptr && sidechain_bus->isEnabled();
+        auto detector = use_sidechain ? block.getSubsetChannelBlock((size_t)getChannelIndexInProcessBlockBuffer(true, 1, 0), (size_t)sidechain_bus->getNumberOfChannels())
+                                      : channels;
+        process_dynamic(channels, detector, chain_settings, dynamic_settings, control_rate);
+    }
+    else if (!coefficient_smoother.is_smoothing())
+    {
+        // Coefficients are designed on the background thread, here we only pick up the newest set
+        update_filters<SampleType>();
+        stage_profiler.mark(StageProfiler::stage::coefficients);
+        process_biquad(chains.biquad, channels);
     }
+    else
+    {
+        // While a ramp runs the smoother owns the coefficients, anything the designer
+        // publishes meanwhile is older than the ramp target
+        filter_designer.pull(designed_coefficients);
+        CoefficientSet coefficient_set;
+
+        for (size_t start = 0; start < channels.getNumSamples(); start += (size_t)control_rate)
+        {
+            auto num_samples = juce::jmin((size_t)control_rate, channels.getNumSamples() - start);
+            coefficient_smoother.advance((int)num_samples, coefficient_set);
+            chains.biquad.update(coefficient_set);
+            stage_profiler.mark(StageProfiler::stage::coefficients);
+            process_biquad(chains.biquad, channels.getSubBlock(start, num_samples));
+        }
+    }
+
+    // The filters are cleared as they go to sleep, so no denormals are left ringing in them
+    if (silence_detector.process_output(channels, get_tail_samples()))
+        reset_filters();
+
+    spectrum_analyser.push_post(channels);
+    stage_profiler.mark(StageProfiler::stage::analysis);
+    stage_profiler.end_block((int)channels.getNumSamples());
+}
+
+void SEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    process_samples(buffer);
+}
 
-    auto& right_low_cut = right_chain.get<(int)chain_positions::low_cut>();
+void SEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    process_samples(buffer);
+}
 
-    right_low_cut.setBypassed<0>(true);
-    right_low_cut.setBypassed<1>(true);
-    right_low_cut.setBypassed<2>(true);
-    right_low_cut.setBypassed<3>(true);
-    switch (chain_settings.low_cut_slope)
+template <typename SampleType>
+void SEQAudioProcessor::process_biquad(SIMDFilterChain<SampleType>& biquad, const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    // Running the parts one after the other changes the cost, so it's only done while timed
+    if (!stage_profiler.is_recording())
     {
-    case slope::slope_12:
+        biquad.process(block);
+        return;
+    }
+
+    static constexpr StageProfiler::stage part_stages[] = { StageProfiler::stage::low_cut, StageProfiler::stage::bands, StageProfiler::stage::high_cut };
+    static_assert(std::size(part_stages) == SIMDFilterChain<SampleType>::num_parts);
+    biquad.process(block, [this](int part) noexcept { stage_profiler.mark(part_stages[part]); });
+}
+
+template <typename SampleType>
+void SEQAudioProcessor::process_state_variable(const juce::dsp::AudioBlock<SampleType>& channels, const ChainSettings& chain_settings, int control_rate) noexcept
+{
+    auto& state_variable = get_chains<SampleType>().state_variable;
+
+    // Designing is a tan() per band, so follow the parameters directly and let the
+    // chain ramp per sample between control points
+    if (!coefficient_smoother.is_smoothing())
     {
-        *right_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        right_low_cut.setBypassed<0>(false);
-        break;
-    };
-    case slope::slope_24:
+        state_variable.update(design_svf(chain_settings, getSampleRate()));
+        stage_profiler.mark(StageProfiler::stage::coefficients);
+        state_variable.process(channels);
+        stage_profiler.mark(StageProfiler::stage::whole_chain);
+        return;
+    }
+
+    for (size_t start = 0; start < channels.getNumSamples(); start += (size_t)control_rate)
     {
-        *right_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        right_low_cut.setBypassed<0>(false);
-        *right_low_cut.get<1>().coefficients = *cut_coefficients[1];
-        right_low_cut.setBypassed<1>(false);
-        break;
-    };
-    case slope::slope_36:
+        auto num_samples = juce::jmin((size_t)control_rate, channels.getNumSamples() - start);
+        state_variable.update(design_svf(coefficient_smoother.advance((int)num_samples), getSampleRate()));
+        stage_profiler.mark(StageProfiler::stage::coefficients);
+        state_variable.process(channels.getSubBlock(start, num_samples));
+        stage_profiler.mark(StageProfiler::stage::whole_chain);
+    }
+}
+
+template <typename SampleType>
+void SEQAudioProcessor::process_morph(const juce::dsp::AudioBlock<SampleType>& channels, int control_rate) noexcept
+{
+    // The parameters don't drive the chain while it morphs, there's nothing to ramp
+    coefficient_smoother.snap_to_target();
+    morphing = true;
+
+    const int indices[] = { current_program.load(), juce::jlimit(0, SnapshotBank::num_snapshots - 1, (int)morph_target_parameter->load()) };
+    for (size_t i = 0; i < morph_sources.size(); ++i)
     {
-        *right_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        right_low_cut.setBypassed<0>(false);
-        *right_low_cut.get<1>().coefficients = *cut_coefficients[1];
-        right_low_cut.setBypassed<1>(false);
-        *right_low_cut.get<2>().coefficients = *cut_coefficients[2];
-        right_low_cut.setBypassed<2>(false);
-        break;
+        if (indices[i] != morph_source_indices[i])
+        {
+            morph_source_indices[i] = indices[i];
+            morph_source_versions[i] = 0;
+        }
+        snapshot_bank.read(indices[i], morph_sources[i], morph_source_versions[i]);
+    }
 
-    };
-    case slope::slope_48:
-    {
-        *right_low_cut.get<0>().coefficients = *cut_coefficients[0];
-        right_low_cut.setBypassed<0>(false);
-        *right_low_cut.get<1>().coefficients = *cut_coefficients[1];
-        right_low_cut.setBypassed<1>(false);
-        *right_low_cut.get<2>().coefficients = *cut_coefficients[2];
-        right_low_cut.setBypassed<2>(false);
-        *right_low_cut.get<3>().coefficients = *cut_coefficients[3];
-        right_low_cut.setBypassed<3>(false);
-        break;
-    };
+    auto& biquad = get_chains<SampleType>().biquad;
+    auto step = control_rate > 0 ? (size_t)control_rate : channels.getNumSamples();
+    for (size_t start = 0; start < channels.getNumSamples(); start += step)
+    {
+        auto num_samples = juce::jmin(step, channels.getNumSamples() - start);
+        biquad.update(morph_coefficients(morph_sources[0], morph_sources[1], morph_amount.skip((int)num_samples)));
+        stage_profiler.mark(StageProfiler::stage::coefficients);
+        process_biquad(biquad, channels.getSubBlock(start, num_samples));
     }
+}
 
-    juce::dsp::AudioBlock<float>block(buffer);
-    auto left_block = block.getSingleChannelBlock(0);
-    auto right_block = block.getSingleChannelBlock(1);
-    juce::dsp::ProcessContextReplacing<float>left_context(left_block);
-    juce::dsp::ProcessContextReplacing<float>right_context(right_block);
-    this->left_chain.process(left_context);
-    this->right_chain.process(right_context);
+template <typename SampleType>
+void SEQAudioProcessor::process_dynamic(const juce::dsp::AudioBlock<SampleType>& channels, const juce::dsp::AudioBlock<SampleType>& detector,
+                                        const ChainSettings& chain_settings, const DynamicSettings& dynamic_settings, int control_rate) noexcept
+{
+    auto& biquad = get_chains<SampleType>().biquad;
+    auto smoothing = coefficient_smoother.is_smoothing();
+    if (smoothing)
+        filter_designer.pull(designed_coefficients);
+    else
+        update_filters<SampleType>();
+
+    auto band = chain_settings.bands[0];
+    auto step = (size_t)(control_rate > 0 ? control_rate : DynamicBand::default_control_rate);
+    for (size_t start = 0; start < channels.getNumSamples(); start += step)
+    {
+        auto num_samples = juce::jmin(step, channels.getNumSamples() - start);
+        if (smoothing)
+        {
+            auto smoothed_settings = coefficient_smoother.advance((int)num_samples);
+            biquad.update(design_coefficients(smoothed_settings, getSampleRate()));
+            band = smoothed_settings.bands[0];
+        }
+
+        biquad.update_section(CoefficientSet::first_band_id, dynamic_band.process(detector.getSubBlock(start, num_samples), band, chain_settings.filter_design, dynamic_settings));
+        stage_profiler.mark(StageProfiler::stage::coefficients);
+        process_biquad(biquad, channels.getSubBlock(start, num_samples));
+    }
 }
 
 //==============================================================================
@@ -401,19 +694,56 @@ void SEQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
     juce::MemoryOutputStream memory_output_stream(destData, true);
-    audio_processor_value_tree_state.state.writeToStream(memory_output_stream);
-
+    write_binary_state(memory_output_stream, getParameters(), snapshot_bank, current_program.load());
 }
 
 void SEQAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
-    auto temp_tree = juce::ValueTree::readFromData(data, sizeInBytes);
+    auto program = current_program.load();
+    filter_designer.restore([&]
+    {
+        if (is_binary_state(data, sizeInBytes))
+        {
+            juce::MemoryInputStream memory_input_stream(data, (size_t)sizeInBytes, false);
+            read_binary_state(memory_input_stream, getParameters(), snapshot_bank, program);
+        }
+        else
+        {
+            read_value_tree_state(data, sizeInBytes, program);
+        }
+    });
+    current_program = program;
+
+    // A loaded state is a jump, not automation to ramp through
+    snap_smoother_pending = true;
+}
+
+void SEQAudioProcessor::write_value_tree_state(juce::MemoryBlock& destData)
+{
+    juce::MemoryOutputStream memory_output_stream(destData, true);
+    auto state = audio_processor_value_tree_state.copyState();
+    auto snapshots = snapshot_bank.to_value_tree();
+    snapshots.setProperty("current", current_program.load(), nullptr);
+    state.appendChild(snapshots, nullptr);
+    state.writeToStream(memory_output_stream);
+}
+
+void SEQAudioProcessor::read_value_tree_state(const void* data, int size_in_bytes, int& program)
+{
+    auto temp_tree = juce::ValueTree::readFromData(data, (size_t)size_in_bytes);
     if (temp_tree.isValid())
     {
+        // The snapshots are kept by the bank, not in the parameter state
+        auto snapshots = temp_tree.getChildWithName(SnapshotBank::state_type);
+        if (snapshots.isValid())
+        {
+            snapshot_bank.from_value_tree(snapshots);
+            program = juce::jlimit(0, SnapshotBank::num_snapshots - 1, (int)snapshots.getProperty("current", 0));
+            temp_tree.removeChild(snapshots, nullptr);
+        }
         audio_processor_value_tree_state.replaceState(temp_tree);
-        /*TODO : Do refactoring and call the update_filter here!*/
     }
 }
 
@@ -440,23 +770,33 @@ juce::AudioProcessorValueTreeState::ParameterLayout SEQAudioProcessor::create_pa
         juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 1.f), 20000.f
         )
     );
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        PEAK_FREQ,
-        PEAK_FREQ,
-        juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 1.f), 750.f
-        )
-    );
-    layout.add(std::make_unique<juce::AudioParameterFloat>(PEAK_GAIN,
-        PEAK_GAIN,
-        juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.f
-        )
-    );
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        PEAK_QUALITY,
-        PEAK_QUALITY,
-        juce::NormalisableRange<float>(-0.1f, 10.f, 0.05f, 1.f), 1.f
-        )
-    );
+    // Freq, Gain and Quality of one band. Band 1 is the original peak and keeps its
+    // place in the layout, everything added later goes at the end
+    auto add_band_parameters = [&layout](int band, float default_freq)
+    {
+        auto freq_id = get_band_parameter_id(band, BAND_FREQ);
+        auto gain_id = get_band_parameter_id(band, BAND_GAIN);
+        auto quality_id = get_band_parameter_id(band, BAND_QUALITY);
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            freq_id,
+            freq_id,
+            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 1.f), default_freq
+            )
+        );
+        layout.add(std::make_unique<juce::AudioParameterFloat>(gain_id,
+            gain_id,
+            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.f
+            )
+        );
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            quality_id,
+            quality_id,
+            juce::NormalisableRange<float>(-0.1f, 10.f, 0.05f, 1.f), 1.f
+            )
+        );
+    };
+    add_band_parameters(0, 750.f);
     juce::StringArray string_array;
     for (uint16_t i = 0; i < 4; ++i)
     {
@@ -467,5 +807,49 @@ juce::AudioProcessorValueTreeState::ParameterLayout SEQAudioProcessor::create_pa
     };
     layout.add(std::make_unique<juce::AudioParameterChoice>(LOW_CUT_SLOPE,LOW_CUT_SLOPE , string_array, 0));
     layout.add(std::make_unique<juce::AudioParameterChoice>(HIGH_CUT_SLOPE, HIGH_CUT_SLOPE, string_array, 0));
+
+    // Control rate at which automation is re-designed while it ramps
+    layout.add(std::make_unique<juce::AudioParameterChoice>(SMOOTHING, SMOOTHING, juce::StringArray{ "Off", "16 Samples", "32 Samples", "64 Samples" }, 2));
+
+    // Analog matched avoids the cramping near Nyquist without oversampling
+    layout.add(std::make_unique<juce::AudioParameterChoice>(DESIGN_MODE, DESIGN_MODE, juce::StringArray{ "Bilinear", "Analog Matched" }, 0));
+
+    // Linear phase costs latency, moving any of the three prepares the processor again
+    layout.add(std::make_unique<juce::AudioParameterChoice>(PHASE_MODE, PHASE_MODE, juce::StringArray{ "Minimum Phase", "Linear Phase" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(LINEAR_PHASE_LENGTH, LINEAR_PHASE_LENGTH, juce::StringArray{ "4096", "8192", "16384" }, 1));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(LINEAR_PHASE_PARTITIONING, LINEAR_PHASE_PARTITIONING, juce::StringArray{ "Zero Latency", "Low CPU" }, 0));
+
+    // State Variable follows fast modulation without redesigning biquads
+    layout.add(std::make_unique<juce::AudioParameterChoice>(FILTER_TOPOLOGY, FILTER_TOPOLOGY, juce::StringArray{ "Biquad", "State Variable" }, 0));
+
+    // Bands 2 to 8 start at 0 dB, so they cost nothing until they're used
+    static constexpr float default_band_freqs[num_bands] = { 750.f, 60.f, 150.f, 400.f, 1500.f, 3000.f, 6000.f, 12000.f };
+    for (int band = 0; band < num_bands; ++band)
+    {
+        if (band > 0)
+            add_band_parameters(band, default_band_freqs[band]);
+
+        auto type_id = get_band_parameter_id(band, BAND_TYPE);
+        layout.add(std::make_unique<juce::AudioParameterChoice>(type_id, type_id, juce::StringArray{ "Peak", "Low Shelf", "High Shelf", "Notch" }, 0));
+    }
+
+    // Morphs the biquad chain from the current program towards the target, between their stored sets
+    juce::StringArray snapshot_names;
+    for (int i = 0; i < SnapshotBank::num_snapshots; ++i)
+        snapshot_names.add("Snapshot " + juce::String(i + 1));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(MORPH_TARGET, MORPH_TARGET, snapshot_names, 1));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(MORPH, MORPH, juce::NormalisableRange<float>(0.f, 1.f, 0.001f, 1.f), 0.f));
+
+    // Band 1 pulled down by the level of the input or the sidechain, in the biquad topology
+    layout.add(std::make_unique<juce::AudioParameterChoice>(DYNAMIC_SOURCE, DYNAMIC_SOURCE, juce::StringArray{ "Off", "Input", "Sidechain" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(DYNAMIC_THRESHOLD, DYNAMIC_THRESHOLD, juce::NormalisableRange<float>(-60.f, 0.f, 0.1f, 1.f), -20.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(DYNAMIC_RATIO, DYNAMIC_RATIO, juce::NormalisableRange<float>(1.f, 20.f, 0.1f, 0.5f), 2.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(DYNAMIC_ATTACK, DYNAMIC_ATTACK, juce::NormalisableRange<float>(0.1f, 100.f, 0.1f, 0.5f), 5.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(DYNAMIC_RELEASE, DYNAMIC_RELEASE, juce::NormalisableRange<float>(5.f, 1000.f, 1.f, 0.5f), 100.f));
+
+    // Multirate runs the low cut at 44.1 or 48 kHz when the session rate is 88.2 kHz and up,
+    // where a low corner is better conditioned. It adds latency, so like Phase Mode moving it
+    // prepares the processor again from the message thread
+    layout.add(std::make_unique<juce::AudioParameterChoice>(LOW_CUT_MODE, LOW_CUT_MODE, juce::StringArray{ "Full Rate", "Multirate" }, 0));
     return layout;
 }
\ No newline at end of file
@@ -10,42 +10,26 @@
 #pragma once
 
 #include <JuceHeader.h>
-#define LOW_CUT_FREQ "LowCut Freq"
-#define HIGH_CUT_FREQ "HighCut Freq"
-#define PEAK_FREQ "Peak Freq"
-#define PEAK_QUALITY "Peak Quality"
-#define PEAK_GAIN "Peak Gain"
-#define LOW_CUT_SLOPE "LowCut Slope"
-#define HIGH_CUT_SLOPE "HighCut Slope"
-
-enum class chain_positions
-{
-    low_cut,
-    peak,
-    high_cut
-};
-
-enum class slope
-{
-    slope_12,
-    slope_24,
-    slope_36,
-    slope_48
-};
-
-struct ChainSettings
-{
-    float peak_freq{ 0 }, peak_gain_in_decibels{ 0 }, peak_quality{ 1.f };
-    float low_cut_freq{ 0 }, high_cut_freq{ 0 };
-    slope low_cut_slope{slope::slope_12}, high_cut_slope{slope::slope_12};
-};
-
-struct ChainSettings get_chain_settings(juce::AudioProcessorValueTreeState&);
+#include "ChainSettings.h"
+#include "FilterDesigner.h"
+#include "SIMDFilterChain.h"
+#include "CoefficientSmoother.h"
+#include "RealtimeSafety.h"
+#include "SpectrumAnalyser.h"
+#include "LinearPhaseFilter.h"
+#include "SVFFilterChain.h"
+#include "SilenceDetector.h"
+#include "SnapshotBank.h"
+#include "DynamicBand.h"
+#include "StageProfiler.h"
+#include "StateFormat.h"
 
 //==============================================================================
 /**
 */
-class SEQAudioProcessor  : public juce::AudioProcessor
+class SEQAudioProcessor  : public juce::AudioProcessor,
+                           private juce::AudioProcessorValueTreeState::Listener,
+                           private juce::Timer
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
@@ -64,6 +48,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -91,12 +77,152 @@ public:
     //Juce requires All  apvt parameter at compile time
     static juce::AudioProcessorValueTreeState::ParameterLayout create_parameter_layout();//return
     juce::AudioProcessorValueTreeState audio_processor_value_tree_state{ *this, nullptr, "Parameters", SEQAudioProcessor::create_parameter_layout() };
+
+    // Fed from processBlock only while an editor has it enabled
+    SpectrumAnalyser& get_spectrum_analyser() noexcept { return spectrum_analyser; }
+    const FilterDesigner& get_filter_designer() const noexcept { return filter_designer; }
+
+    // Off until the editor switches it on, then times every block by stage
+    StageProfiler& get_stage_profiler() noexcept { return stage_profiler; }
+
+    // Pins the control rate in samples for the benchmark, 0 snaps without a ramp and -1 goes back to the Smoothing parameter
+    void set_control_rate_override(int samples) noexcept { control_rate_override = samples; }
+
+    // Stores the current settings in a program slot, designed for the current sample rate
+    void store_snapshot(int index);
+
+    // The state as every build before the binary format saved it. setStateInformation
+    // still reads it, this writes it for comparisons and for older builds
+    void write_value_tree_state(juce::MemoryBlock&);
 private:
 
-    using filter = juce::dsp::IIR::Filter<float>;
-    using cut_filter = juce::dsp::ProcessorChain<filter, filter, filter, filter>;
-    using mono_chain = juce::dsp::ProcessorChain<cut_filter, filter, cut_filter>;
-    mono_chain left_chain, right_chain;
+    // The IIR chains for one processing precision. Only the set matching
+    // isUsingDoublePrecision() is prepared and run
+    template <typename SampleType>
+    struct FilterChains
+    {
+        // One chain for all channels, each biquad runs the channels in SIMD lanes, or for
+        // mono consecutive samples of the one channel
+        SIMDFilterChain<SampleType> biquad;
+
+        // Alternative to biquad that redesigns with one tan() and ramps per sample
+        SVFFilterChain<SampleType> state_variable;
+
+        // Holds the state variable output back by the multirate low cut's latency,
+        // so switching topology doesn't move the audio against what the host compensates
+        juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None> state_variable_delay;
+    };
+
+    FilterChains<float> float_chains;
+    FilterChains<double> double_chains;
+
+    template <typename SampleType>
+    FilterChains<SampleType>& get_chains() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return double_chains;
+        else
+            return float_chains;
+    }
+
+    template <typename SampleType>
+    void process_samples(juce::AudioBuffer<SampleType>&) noexcept;
+
+    ChainParameters chain_parameters;
+    FilterDesigner filter_designer{ chain_parameters };
+
+    // Ramps automation and redesigns every few samples while a ramp runs
+    CoefficientSmoother coefficient_smoother;
+    std::atomic<float>* smoothing_parameter{ nullptr };
+    std::atomic<int> control_rate_override{ -1 };
+    int get_control_rate() const noexcept;
+
+    std::atomic<float>* topology_parameter{ nullptr };
+    filter_topology active_topology{ filter_topology::biquad };
+    // The biquad chain, timed by part while the stage profiler records
+    template <typename SampleType>
+    void process_biquad(SIMDFilterChain<SampleType>&, const juce::dsp::AudioBlock<SampleType>&) noexcept;
+
+    template <typename SampleType>
+    void process_state_variable(const juce::dsp::AudioBlock<SampleType>&, const ChainSettings&, int control_rate) noexcept;
+
+    template <typename SampleType>
+    void update_filters() noexcept;
+
+    // The newest set from the designer, what the biquad chain returns to after a morph
+    CoefficientSet designed_coefficients;
+
+    // The programs. Recalling one publishes its stored set through the designer, nothing is
+    // designed, and leaves recalled_program for the timer to write its settings to the parameters
+    SnapshotBank snapshot_bank;
+    std::atomic<int> current_program{ 0 };
+    std::atomic<int> recalled_program{ -1 };
+    std::atomic<bool> snap_smoother_pending{ false };
+
+    // Sessions saved before the binary state format
+    void read_value_tree_state(const void* data, int size_in_bytes, int& program);
+
+    // Morph runs the biquad chain from the current program towards the Morph Target,
+    // interpolating their stored sets. Each side is copied again only when its slot changes
+    std::atomic<float>* morph_parameter{ nullptr };
+    std::atomic<float>* morph_target_parameter{ nullptr };
+    juce::SmoothedValue<float> morph_amount;
+    std::array<CoefficientSet, 2> morph_sources;
+    std::array<int, 2> morph_source_indices{ -1, -1 };
+    std::array<juce::uint32, 2> morph_source_versions{ 0, 0 };
+    bool morphing{ false };
+    template <typename SampleType>
+    void process_morph(const juce::dsp::AudioBlock<SampleType>&, int control_rate) noexcept;
+
+    // Band 1 following the input or the sidechain. Only its section is redesigned
+    // between sub-blocks, the rest of the chain keeps the designer's set
+    DynamicParameters dynamic_parameters;
+    DynamicBand dynamic_band;
+    template <typename SampleType>
+    void process_dynamic(const juce::dsp::AudioBlock<SampleType>& channels, const juce::dsp::AudioBlock<SampleType>& detector,
+                         const ChainSettings&, const DynamicSettings&, int control_rate) noexcept;
+
+    // Replaces the IIR chain when Phase Mode is linear. The mode, kernel length
+    // and partitioning change the latency, so they only take effect in prepareToPlay
+    LinearPhaseFilter linear_phase_filter{ filter_designer };
+    bool use_linear_phase{ false };
+
+    // The parameters that set the latency, as the last prepareToPlay read them. When one
+    // of them moves, parameterChanged only raises latency_change_pending, since automation
+    // can come from the audio thread. The timer picks it up on the message thread and
+    // prepares again there, and setLatencySamples tells the host. The same timer writes a
+    // recalled program's settings to the parameters
+    struct LatencySettings
+    {
+        bool linear_phase{ false };
+        int kernel_length{ 0 };
+        convolution_partitioning partitioning{ convolution_partitioning::zero_latency };
+        bool multirate_low_cut{ false };
+
+        bool operator==(const LatencySettings& other) const noexcept
+        {
+            return linear_phase == other.linear_phase && kernel_length == other.kernel_length && partitioning == other.partitioning
+                && multirate_low_cut == other.multirate_low_cut;
+        }
+    };
+    LatencySettings prepared_latency_settings;
+    LatencySettings get_latency_settings() const noexcept;
+    std::atomic<bool> latency_change_pending{ false };
+    void parameterChanged(const juce::String& parameter_id, float new_value) override;
+    void timerCallback() override;
+
+    // Low Cut Mode: at 88.2 kHz and up the biquad chain can run its low cut at a lower
+    // rate, which adds latency, so it's also one of the LatencySettings. It follows
+    // the parameters block by block and isn't ramped or morphed with the bands
+    bool use_multirate_low_cut{ false };
+
+    SpectrumAnalyser spectrum_analyser;
+    StageProfiler stage_profiler;
+
+    // Skips the whole chain once the input is silent and the tail has rung out
+    SilenceDetector silence_detector;
+    int get_tail_samples() const noexcept;
+    void reset_filters() noexcept;
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SEQAudioProcessor)
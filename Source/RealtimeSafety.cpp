@@ -0,0 +1,256 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Debug/test mode that traps realtime-unsafe calls made from inside the
+    audio callback.
+
+  ==============================================================================
+*/
+
+#include "RealtimeSafety.h"
+
+#if SEQ_REALTIME_CHECKS
+
+#include <new>
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <execinfo.h>
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #define SEQ_HAS_BACKTRACE 1
+#else
+ #define SEQ_HAS_BACKTRACE 0
+#endif
+
+#if JUCE_LINUX && defined (__GLIBC__)
+ #define SEQ_HOOK_LIBC 1
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void __libc_free(void*);
+#else
+ #define SEQ_HOOK_LIBC 0
+#endif
+
+// The hooks run inside malloc, so the thread locals must never need a lazy allocation themselves
+#if JUCE_GCC || JUCE_CLANG
+ #define SEQ_INITIAL_EXEC_TLS __attribute__((tls_model("initial-exec")))
+#else
+ #define SEQ_INITIAL_EXEC_TLS
+#endif
+
+namespace
+{
+    constexpr int max_records = 256, max_frames = 32;
+
+    struct Record
+    {
+        RealtimeSafety::violation type;
+        int num_frames;
+        void* frames[max_frames];
+    };
+
+    thread_local int audio_callback_depth SEQ_INITIAL_EXEC_TLS = 0;
+    thread_local bool inside_hook SEQ_INITIAL_EXEC_TLS = false;
+    thread_local int num_allowed_locks SEQ_INITIAL_EXEC_TLS = 0;
+
+    std::atomic<int> violation_counts[3];
+    std::atomic<int> num_records{ 0 };
+    Record records[max_records];
+
+    // Runs the real allocator without reporting it again
+    template <typename Function>
+    auto call_unhooked(Function&& function) noexcept
+    {
+        auto was_inside_hook = inside_hook;
+        inside_hook = true;
+        auto result = function();
+        inside_hook = was_inside_hook;
+        return result;
+    }
+}
+
+RealtimeSafety::ScopedAudioCallback::ScopedAudioCallback() noexcept { ++audio_callback_depth; }
+RealtimeSafety::ScopedAudioCallback::~ScopedAudioCallback() noexcept { --audio_callback_depth; }
+
+RealtimeSafety::ScopedHostListenerLock::ScopedHostListenerLock() noexcept { num_allowed_locks = 1; }
+RealtimeSafety::ScopedHostListenerLock::~ScopedHostListenerLock() noexcept { num_allowed_locks = 0; }
+
+void RealtimeSafety::report(violation type) noexcept
+{
+    if (audio_callback_depth == 0 || inside_hook)
+        return;
+
+    if (type == violation::lock && num_allowed_locks > 0)
+    {
+        --num_allowed_locks;
+        return;
+    }
+
+    inside_hook = true;
+    ++violation_counts[(int)type];
+
+    auto index = num_records++;
+    if (index < max_records)
+    {
+        auto& record = records[index];
+        record.type = type;
+       #if SEQ_HAS_BACKTRACE
+        record.num_frames = backtrace(record.frames, max_frames);
+       #else
+        record.num_frames = 0;
+       #endif
+    }
+    inside_hook = false;
+}
+
+int RealtimeSafety::get_num_violations(violation type) noexcept
+{
+    return violation_counts[(int)type].load();
+}
+
+juce::Array<juce::var> RealtimeSafety::get_violation_reports()
+{
+    juce::Array<juce::var> reports;
+    auto num_recorded = juce::jmin(num_records.load(), max_records);
+
+    for (int i = 0; i < num_recorded; ++i)
+    {
+        auto& record = records[i];
+        juce::StringArray stack;
+       #if SEQ_HAS_BACKTRACE
+        if (auto* symbols = backtrace_symbols(record.frames, record.num_frames))
+        {
+            // Skip report() and the hook itself
+            for (int frame = 2; frame < record.num_frames; ++frame)
+                stack.add(symbols[frame]);
+            free(symbols);
+        }
+       #endif
+
+        auto* report_object = new juce::DynamicObject();
+        report_object->setProperty("type", get_name(record.type));
+        report_object->setProperty("stack", stack);
+        reports.add(report_object);
+    }
+    return reports;
+}
+
+void RealtimeSafety::reset() noexcept
+{
+    for (auto& count : violation_counts)
+        count = 0;
+    num_records = 0;
+}
+
+//==============================================================================
+void* operator new(std::size_t size)
+{
+    RealtimeSafety::report(RealtimeSafety::violation::allocation);
+    if (auto* memory = call_unhooked([size] { return std::malloc(size); }))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    RealtimeSafety::report(RealtimeSafety::violation::allocation);
+    return call_unhooked([size] { return std::malloc(size); });
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& nothrow) noexcept
+{
+    return operator new(size, nothrow);
+}
+
+void operator delete(void* memory) noexcept
+{
+    if (memory == nullptr)
+        return;
+    RealtimeSafety::report(RealtimeSafety::violation::deallocation);
+    call_unhooked([memory] { std::free(memory); return 0; });
+}
+
+void operator delete[](void* memory) noexcept { operator delete(memory); }
+void operator delete(void* memory, std::size_t) noexcept { operator delete(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { operator delete(memory); }
+
+#if SEQ_HOOK_LIBC
+extern "C" void* malloc(size_t size)
+{
+    RealtimeSafety::report(RealtimeSafety::violation::allocation);
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+    RealtimeSafety::report(RealtimeSafety::violation::allocation);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* memory, size_t size)
+{
+    RealtimeSafety::report(RealtimeSafety::violation::allocation);
+    return __libc_realloc(memory, size);
+}
+
+extern "C" void free(void* memory)
+{
+    if (memory != nullptr)
+        RealtimeSafety::report(RealtimeSafety::violation::deallocation);
+    __libc_free(memory);
+}
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    // Constant initialised, a function-local static would take a guard lock on first use
+    using lock_function = int (*)(pthread_mutex_t*);
+    static std::atomic<lock_function> next_lock{ nullptr };
+
+    auto lock = next_lock.load(std::memory_order_relaxed);
+    if (lock == nullptr)
+    {
+        lock = reinterpret_cast<lock_function>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        next_lock = lock;
+    }
+
+    RealtimeSafety::report(RealtimeSafety::violation::lock);
+    return lock(mutex);
+}
+#endif
+
+#else
+
+RealtimeSafety::ScopedAudioCallback::ScopedAudioCallback() noexcept {}
+RealtimeSafety::ScopedAudioCallback::~ScopedAudioCallback() noexcept {}
+RealtimeSafety::ScopedHostListenerLock::ScopedHostListenerLock() noexcept {}
+RealtimeSafety::ScopedHostListenerLock::~ScopedHostListenerLock() noexcept {}
+
+void RealtimeSafety::report(violation) noexcept {}
+int RealtimeSafety::get_num_violations(violation) noexcept { return 0; }
+juce::Array<juce::var> RealtimeSafety::get_violation_reports() { return {}; }
+void RealtimeSafety::reset() noexcept {}
+
+#endif
+
+int RealtimeSafety::get_total_violations() noexcept
+{
+    return get_num_violations(violation::allocation) + get_num_violations(violation::deallocation) + get_num_violations(violation::lock);
+}
+
+juce::String RealtimeSafety::get_name(violation type)
+{
+    switch (type)
+    {
+    case violation::allocation: return "allocation";
+    case violation::deallocation: return "deallocation";
+    case violation::lock: return "lock";
+    }
+    return {};
+}
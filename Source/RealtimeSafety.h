@@ -0,0 +1,70 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Debug/test mode that traps realtime-unsafe calls made from inside the
+    audio callback.
+
+    Build with SEQ_REALTIME_CHECKS=1 and operator new/delete, the malloc
+    family (glibc) and pthread_mutex_lock are hooked. Any of them called
+    while a ScopedAudioCallback is alive on the calling thread is counted and
+    its stack is kept for the report. With the flag off (the default) all of
+    this compiles away and the counters stay at zero.
+
+    The hooks replace allocator symbols for the whole process, so never ship
+    a plugin built with the flag on.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef SEQ_REALTIME_CHECKS
+ #define SEQ_REALTIME_CHECKS 0
+#endif
+
+class RealtimeSafety
+{
+public:
+    enum class violation
+    {
+        allocation,
+        deallocation,
+        lock
+    };
+
+    // Marks the calling thread as running the audio callback
+    struct ScopedAudioCallback
+    {
+        ScopedAudioCallback() noexcept;
+        ~ScopedAudioCallback() noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedAudioCallback)
+    };
+
+    // Lets the next mutex lock on the calling thread through uncounted. The plugin wrappers
+    // apply automation by notifying the parameter's listeners, and JUCE takes the parameter's
+    // listener lock before calling any of them; whatever the listeners do is still counted
+    struct ScopedHostListenerLock
+    {
+        ScopedHostListenerLock() noexcept;
+        ~ScopedHostListenerLock() noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedHostListenerLock)
+    };
+
+    static constexpr bool is_enabled() noexcept { return SEQ_REALTIME_CHECKS != 0; }
+
+    static int get_num_violations(violation) noexcept;
+    static int get_total_violations() noexcept;
+
+    // One entry per recorded violation (the first few hundred): its type and a symbolised stack
+    static juce::Array<juce::var> get_violation_reports();
+    static void reset() noexcept;
+
+    static void report(violation) noexcept;
+
+    static juce::String get_name(violation);
+};
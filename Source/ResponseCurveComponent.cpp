@@ -0,0 +1,97 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    The combined magnitude response of the whole chain.
+
+  ==============================================================================
+*/
+
+#include "ResponseCurveComponent.h"
+
+ResponseCurveComponent::ResponseCurveComponent(const FilterDesigner& filter_designer)
+    : designer(filter_designer)
+{
+    setInterceptsMouseClicks(false, false);
+    startTimerHz(60);
+}
+
+ResponseCurveComponent::~ResponseCurveComponent()
+{
+    stopTimer();
+}
+
+void ResponseCurveComponent::resized()
+{
+    needs_update = true;
+    update_path();
+}
+
+void ResponseCurveComponent::timerCallback()
+{
+    if (needs_update || designer.get_generation() != drawn_generation)
+    {
+        update_path();
+        repaint();
+    }
+}
+
+void ResponseCurveComponent::update_grid(double sample_rate)
+{
+    auto num_points = (size_t)juce::jmax(2, getWidth());
+    if (sample_rate == grid_sample_rate && cos_w.size() == num_points)
+        return;
+
+    grid_sample_rate = sample_rate;
+    cos_w.resize(num_points);
+    cos_2w.resize(num_points);
+    magnitudes_squared.resize(num_points);
+
+    for (size_t i = 0; i < num_points; ++i)
+    {
+        auto frequency = juce::mapToLog10((double)i / (double)(num_points - 1), 20.0, 20000.0);
+        auto omega = juce::MathConstants<double>::twoPi * juce::jmin(frequency, sample_rate * 0.5) / sample_rate;
+        cos_w[i] = (float)std::cos(omega);
+        cos_2w[i] = (float)std::cos(2.0 * omega);
+    }
+}
+
+void ResponseCurveComponent::update_path()
+{
+    // Read the generation first, a set published in between just costs one more update
+    drawn_generation = designer.get_generation();
+    needs_update = false;
+    response_curve.clear();
+
+    double sample_rate = 0.0;
+    auto coefficient_set = designer.get_coefficients(sample_rate);
+    if (sample_rate <= 0.0 || getWidth() <= 0)
+        return;
+
+    update_grid(sample_rate);
+    auto num_points = (int)magnitudes_squared.size();
+    std::fill(magnitudes_squared.begin(), magnitudes_squared.end(), 1.f);
+
+    for (int i = 0; i < coefficient_set.num_sections; ++i)
+        multiply_by_magnitude_squared(coefficient_set.sections[(size_t)i], cos_w.data(), cos_2w.data(), magnitudes_squared.data(), num_points);
+
+    auto bounds = getLocalBounds().toFloat();
+    response_curve.preallocateSpace(num_points * 3);
+    for (int i = 0; i < num_points; ++i)
+    {
+        // |H|^2 in decibels is 10 log10, which is also what keeps the sqrt out of the loop
+        auto decibels = 10.f * std::log10(juce::jmax(magnitudes_squared[(size_t)i], 1.0e-12f));
+        auto x = bounds.getX() + bounds.getWidth() * (float)i / (float)(num_points - 1);
+        auto y = juce::jmap(juce::jlimit(min_decibels, max_decibels, decibels), max_decibels, min_decibels, bounds.getY(), bounds.getBottom());
+        if (i == 0)
+            response_curve.startNewSubPath(x, y);
+        else
+            response_curve.lineTo(x, y);
+    }
+}
+
+void ResponseCurveComponent::paint(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::white);
+    g.strokePath(response_curve, juce::PathStrokeType(2.f));
+}
@@ -0,0 +1,48 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    The combined magnitude response of the whole chain, drawn over the
+    spectrum in the response area.
+
+    All sections are evaluated in one batched pass over a log frequency grid
+    with one point per pixel column, and the resulting path is cached. The
+    timer only compares the designer's generation counter, so an idle editor
+    never re-evaluates anything.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterDesigner.h"
+
+class ResponseCurveComponent : public juce::Component, private juce::Timer
+{
+public:
+    explicit ResponseCurveComponent(const FilterDesigner&);
+    ~ResponseCurveComponent() override;
+
+    void paint(juce::Graphics&) override;
+    void resized() override;
+
+    static constexpr float min_decibels = -24.f, max_decibels = 24.f;
+
+private:
+    void timerCallback() override;
+    void update_grid(double sample_rate);
+    void update_path();
+
+    const FilterDesigner& designer;
+    juce::uint32 drawn_generation{ 0 };
+    bool needs_update{ true };
+
+    // cos (w) and cos (2w) for every column, rebuilt only when the width or rate changes
+    double grid_sample_rate{ 0.0 };
+    std::vector<float> cos_w, cos_2w, magnitudes_squared;
+
+    juce::Path response_curve;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ResponseCurveComponent)
+};
@@ -0,0 +1,303 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    The band engine, run once for all channels.
+
+  ==============================================================================
+*/
+
+#include "SIMDFilterChain.h"
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::prepare(const juce::dsp::ProcessSpec& spec, bool use_multirate_low_cut)
+{
+    jassert(spec.numChannels <= (juce::uint32)max_channels);
+    auto num_groups = juce::jmax((size_t)1, ((size_t)spec.numChannels + get_num_lanes() - 1) / get_num_lanes());
+
+    states.resize(num_groups);
+    if (use_multirate_low_cut)
+        multirate_low_cut.prepare(spec.sampleRate, num_groups);
+    else
+        multirate_low_cut.release();
+    reset();
+
+    // The multirate low cut runs on interleaved lanes, so it always keeps the interleaved kernel.
+    // Two channels already fill half the lanes in one interleaved pass, so automatic only picks time blocked for mono
+    time_blocked = !multirate_low_cut.is_active()
+                && (requested_layout == lane_layout::time_blocked || (requested_layout == lane_layout::automatic && spec.numChannels == 1));
+    if (time_blocked)
+        for (int i = 0; i < num_sections; ++i)
+            set_time_block_section(i);
+
+    interleaved = juce::dsp::AudioBlock<simd_type>(interleaved_data, 1, spec.maximumBlockSize);
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::reset() noexcept
+{
+    for (int id = 0; id < max_sections; ++id)
+        clear_state(id);
+    multirate_low_cut.reset();
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::clear_state(int id) noexcept
+{
+    for (auto& group : states)
+        group.s1[(size_t)id] = group.s2[(size_t)id] = simd_type((SampleType)0);
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::set_section(int position, const BiquadCoefficients& source) noexcept
+{
+    auto index = (size_t)position;
+    coefficients.b0[index] = simd_type::expand((SampleType)source.b0);
+    coefficients.b1[index] = simd_type::expand((SampleType)source.b1);
+    coefficients.b2[index] = simd_type::expand((SampleType)source.b2);
+    coefficients.a1[index] = simd_type::expand((SampleType)source.a1);
+    coefficients.a2[index] = simd_type::expand((SampleType)source.a2);
+
+    sources[index] = source;
+    if (time_blocked)
+        set_time_block_section(position);
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::set_time_block_section(int position) noexcept
+{
+    // The transposed direct form II as a state space filter: s[n + 1] = A s[n] + B x[n] and
+    // y[n] = C s[n] + b0 x[n], with A = [-a1 1; -a2 0], B = [b1 - a1 b0; b2 - a2 b0], C = [1 0].
+    // So y[n + k] = C A^k s[n] + h[0] x[n + k] + ... + h[k] x[n], designed in double
+    auto index = (size_t)position;
+    const auto& source = sources[index];
+    auto& target = time_block_coefficients;
+
+    alignas(sizeof(simd_type)) std::array<SampleType, num_lanes> state1, state2, lanes;
+    std::array<double, num_lanes> impulse;
+    impulse[0] = source.b0;
+
+    auto c1 = 1.0, c2 = 0.0;
+    for (size_t k = 0; k < num_lanes; ++k)
+    {
+        state1[k] = (SampleType)c1;
+        state2[k] = (SampleType)c2;
+        if (k + 1 < num_lanes)
+            impulse[k + 1] = c1 * (source.b1 - source.a1 * source.b0) + c2 * (source.b2 - source.a2 * source.b0);
+
+        auto next_c1 = -source.a1 * c1 - source.a2 * c2;
+        c2 = c1;
+        c1 = next_c1;
+    }
+
+    target.state1[index] = simd_type::fromRawArray(state1.data());
+    target.state2[index] = simd_type::fromRawArray(state2.data());
+    for (size_t j = 0; j < num_lanes; ++j)
+    {
+        for (size_t k = 0; k < num_lanes; ++k)
+            lanes[k] = k >= j ? (SampleType)impulse[k - j] : (SampleType)0;
+        target.impulse[j][index] = simd_type::fromRawArray(lanes.data());
+    }
+
+    target.b0[index] = (SampleType)source.b0;
+    target.b1[index] = (SampleType)source.b1;
+    target.b2[index] = (SampleType)source.b2;
+    target.a1[index] = (SampleType)source.a1;
+    target.a2[index] = (SampleType)source.a2;
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::update(const CoefficientSet& coefficient_set) noexcept
+{
+    std::array<bool, max_sections> was_active{};
+    for (int i = 0; i < num_sections; ++i)
+        was_active[(size_t)section_ids[(size_t)i]] = true;
+
+    num_sections = 0;
+    section_positions.fill(-1);
+    for (int i = 0; i < coefficient_set.num_sections; ++i)
+    {
+        // The multirate path has its own low cut
+        auto id = coefficient_set.ids[(size_t)i];
+        if (id < CoefficientSet::first_band_id && multirate_low_cut.is_active())
+            continue;
+
+        set_section(num_sections, coefficient_set.sections[(size_t)i]);
+
+        // A band that's just been switched on starts from silence, not from whatever it held last time
+        section_ids[(size_t)num_sections] = id;
+        section_positions[(size_t)id] = num_sections++;
+        if (!was_active[(size_t)id])
+            clear_state(id);
+    }
+
+    // The ids come in processing order, so each part is one run of positions
+    static constexpr int part_first_ids[] = { CoefficientSet::low_cut_id, CoefficientSet::first_band_id, CoefficientSet::high_cut_id };
+    for (int part = 0, position = 0; part < num_parts; ++part)
+    {
+        while (position < num_sections && section_ids[(size_t)position] < part_first_ids[part])
+            ++position;
+        part_starts[(size_t)part] = position;
+    }
+    part_starts[(size_t)num_parts] = num_sections;
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::update_section(int id, const BiquadCoefficients& source) noexcept
+{
+    auto position = section_positions[(size_t)id];
+    if (position >= 0)
+        set_section(position, source);
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::process_group(simd_type* lanes, size_t num_samples, States& group_states, int first, int end) noexcept
+{
+    if (first == end)
+        return;
+
+    // Work on a compact copy so the kernel doesn't chase ids
+    States local;
+    for (int i = first; i < end; ++i)
+    {
+        local.s1[(size_t)(i - first)] = group_states.s1[(size_t)section_ids[(size_t)i]];
+        local.s2[(size_t)(i - first)] = group_states.s2[(size_t)section_ids[(size_t)i]];
+    }
+
+    static constexpr auto kernels = make_kernels(std::make_index_sequence<max_sections>());
+    (this->*kernels[(size_t)(end - first) - 1])(lanes, num_samples, (size_t)first, local);
+
+    for (int i = first; i < end; ++i)
+    {
+        group_states.s1[(size_t)section_ids[(size_t)i]] = local.s1[(size_t)(i - first)];
+        group_states.s2[(size_t)section_ids[(size_t)i]] = local.s2[(size_t)(i - first)];
+    }
+}
+
+template <typename SampleType>
+template <size_t... index>
+void SIMDFilterChain<SampleType>::process_sections(simd_type* lanes, size_t num_samples, size_t first, States& local, std::index_sequence<index...>) const noexcept
+{
+    // The section count is a constant here, so the folds below unroll the whole cascade
+    // and the compiler can keep every section's state in a register
+    simd_type s1[] = { local.s1[index]... };
+    simd_type s2[] = { local.s2[index]... };
+    auto* b0 = coefficients.b0.data() + first;
+    auto* b1 = coefficients.b1.data() + first;
+    auto* b2 = coefficients.b2.data() + first;
+    auto* a1 = coefficients.a1.data() + first;
+    auto* a2 = coefficients.a2.data() + first;
+
+    for (size_t n = 0; n < num_samples; ++n)
+    {
+        auto x = lanes[n];
+        ((x = [&](simd_type in) noexcept
+        {
+            auto y = b0[index] * in + s1[index];
+            s1[index] = b1[index] * in - a1[index] * y + s2[index];
+            s2[index] = b2[index] * in - a2[index] * y;
+            return y;
+        }(x)), ...);
+        lanes[n] = x;
+    }
+
+    ((local.s1[index] = s1[index], local.s2[index] = s2[index]), ...);
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::process_time_blocks(SampleType* samples, size_t num_samples, States& group_states, size_t lane, int first, int end) noexcept
+{
+    if (first == end)
+        return;
+
+    const auto& c = time_block_coefficients;
+
+    // This channel's lane of the group state, the same one the interleaved kernel would use
+    std::array<SampleType, max_sections> s1, s2;
+    for (size_t i = (size_t)first; i < (size_t)end; ++i)
+    {
+        s1[i] = group_states.s1[(size_t)section_ids[i]].get(lane);
+        s2[i] = group_states.s2[(size_t)section_ids[i]].get(lane);
+    }
+
+    alignas(sizeof(simd_type)) std::array<SampleType, num_lanes> x;
+    size_t n = 0;
+    for (; n + num_lanes <= num_samples; n += num_lanes)
+    {
+        std::copy(samples + n, samples + n + num_lanes, x.begin());
+        for (size_t i = (size_t)first; i < (size_t)end; ++i)
+        {
+            // None of the outputs waits for another, only the next block waits for this one
+            auto y = c.state1[i] * s1[i] + c.state2[i] * s2[i];
+            for (size_t j = 0; j < num_lanes; ++j)
+                y += c.impulse[j][i] * x[j];
+
+            // The state after the block is the recursion run on just its last two samples
+            auto last_input = x[num_lanes - 1], previous_input = x[num_lanes - 2];
+            y.copyToRawArray(x.data());
+            auto previous_s2 = c.b2[i] * previous_input - c.a2[i] * x[num_lanes - 2];
+            s2[i] = c.b2[i] * last_input - c.a2[i] * x[num_lanes - 1];
+            s1[i] = c.b1[i] * last_input - c.a1[i] * x[num_lanes - 1] + previous_s2;
+        }
+        std::copy(x.begin(), x.end(), samples + n);
+    }
+
+    // Whatever doesn't fill a register, one sample at a time
+    for (; n < num_samples; ++n)
+    {
+        auto value = samples[n];
+        for (size_t i = (size_t)first; i < (size_t)end; ++i)
+        {
+            auto y = c.b0[i] * value + s1[i];
+            s1[i] = c.b1[i] * value - c.a1[i] * y + s2[i];
+            s2[i] = c.b2[i] * value - c.a2[i] * y;
+            value = y;
+        }
+        samples[n] = value;
+    }
+
+    for (size_t i = (size_t)first; i < (size_t)end; ++i)
+    {
+        group_states.s1[(size_t)section_ids[i]].set(lane, s1[i]);
+        group_states.s2[(size_t)section_ids[i]].set(lane, s2[i]);
+    }
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::interleave(const juce::dsp::AudioBlock<SampleType>& block, size_t first_channel, size_t num_samples) noexcept
+{
+    auto* lanes = reinterpret_cast<SampleType*>(interleaved.getChannelPointer(0));
+    auto num_channels = juce::jmin(block.getNumChannels() - first_channel, get_num_lanes());
+
+    for (size_t channel = 0; channel < get_num_lanes(); ++channel)
+    {
+        if (channel < num_channels)
+        {
+            auto* source = block.getChannelPointer(first_channel + channel);
+            for (size_t i = 0; i < num_samples; ++i)
+                lanes[i * get_num_lanes() + channel] = source[i];
+        }
+        else
+        {
+            for (size_t i = 0; i < num_samples; ++i)
+                lanes[i * get_num_lanes() + channel] = 0;
+        }
+    }
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::deinterleave(const juce::dsp::AudioBlock<SampleType>& block, size_t first_channel, size_t num_samples) noexcept
+{
+    auto* lanes = reinterpret_cast<const SampleType*>(interleaved.getChannelPointer(0));
+    auto num_channels = juce::jmin(block.getNumChannels() - first_channel, get_num_lanes());
+
+    for (size_t channel = 0; channel < num_channels; ++channel)
+    {
+        auto* destination = block.getChannelPointer(first_channel + channel);
+        for (size_t i = 0; i < num_samples; ++i)
+            destination[i] = lanes[i * get_num_lanes() + channel];
+    }
+}
+
+template class SIMDFilterChain<float>;
+template class SIMDFilterChain<double>;
@@ -0,0 +1,247 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    The band engine: the low cut and every band, run once for all channels.
+
+    Every channel shares the same coefficients, so instead of one scalar
+    chain per channel the channels are interleaved into the lanes of a
+    juce::dsp::SIMDRegister and each biquad updates all of them at once.
+    Wider layouts are split into groups of get_num_lanes() channels (four
+    with SSE/NEON, eight with AVX), each group with its own filter state but
+    all of them sharing the same coefficients.
+
+    Only the sections in the CoefficientSet are run, so unity bands cost
+    nothing. They're processed in one fused loop, every section of a sample
+    before the next sample. Coefficients and state are kept as flat arrays
+    per term, and the loop is picked from a table of kernels built for each
+    section count, so the cascade is unrolled at compile time and its state
+    stays in registers for the block.
+
+    Instantiated for float and double. The double chain has half as many
+    lanes per register, but hosts that process in double don't have to
+    convert every block and the low, steep cascades keep their precision.
+
+    Mono would leave all but one lane empty, so it runs with consecutive
+    samples of its channel in the lanes instead. Each section is written
+    as a block state space filter: every output of a block is the state at
+    its start plus the impulse response times the block's inputs, so
+    they're all computed at once, and the state is carried to the next
+    block by the last two samples. The state lives in the same lanes
+    either way.
+
+    At 88.2 kHz and up the low cut can run in MultirateLowCut instead, at a
+    quarter or half of the rate, ahead of the bands.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <utility>
+#include "FilterDesigner.h"
+#include "MultirateLowCut.h"
+
+template <typename SampleType>
+class SIMDFilterChain
+{
+public:
+    using simd_type = juce::dsp::SIMDRegister<SampleType>;
+
+    SIMDFilterChain() { section_positions.fill(-1); }
+
+    static constexpr size_t get_num_lanes() noexcept { return simd_type::size(); }
+    static constexpr int max_channels = 16;
+
+    // Which way the lanes are filled. automatic picks time blocked for mono, unless the
+    // multirate low cut is on, which needs the lanes interleaved
+    enum class lane_layout
+    {
+        automatic,
+        interleaved,
+        time_blocked
+    };
+
+    // Takes effect on the next prepare
+    void set_lane_layout(lane_layout layout) noexcept { requested_layout = layout; }
+    bool is_time_blocked() const noexcept { return time_blocked; }
+
+    // With use_multirate_low_cut the low cut sections of every update are left to
+    // MultirateLowCut, which only takes over at rates where it has something to halve
+    void prepare(const juce::dsp::ProcessSpec&, bool use_multirate_low_cut = false);
+    void reset() noexcept;
+    void update(const CoefficientSet&) noexcept;
+
+    // Audio thread: the low cut for the multirate path, ignored while it's inactive
+    void update_low_cut(design_mode mode, float frequency, slope cut_slope) noexcept { multirate_low_cut.update(mode, frequency, cut_slope); }
+
+    bool is_low_cut_multirate() const noexcept { return multirate_low_cut.is_active(); }
+    int get_latency_samples() const noexcept { return multirate_low_cut.get_latency_samples(); }
+
+    // Replaces the coefficients of one active section and leaves the others alone,
+    // does nothing if the last update didn't include id
+    void update_section(int id, const BiquadCoefficients&) noexcept;
+
+    // The cascade in parts by slot id: the low cut, the bands and the high cut
+    static constexpr int num_parts = 3;
+
+    // Processes up to the prepared number of channels in place
+    void process(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        const int all_sections[] = { 0, num_sections };
+        process_parts(block, all_sections, 1, [](int) noexcept {});
+    }
+
+    // The same, running the parts one after the other and calling on_part_done(part) as each
+    // finishes a group of channels, so they can be timed apart. Moving the lanes in and out
+    // is counted with the first and the last part
+    template <typename Callback>
+    void process(const juce::dsp::AudioBlock<SampleType>& block, Callback&& on_part_done) noexcept
+    {
+        process_parts(block, part_starts.data(), num_parts, on_part_done);
+    }
+
+private:
+    static constexpr int max_sections = CoefficientSet::max_sections;
+
+    // Transposed direct form II, one array per term
+    struct Coefficients
+    {
+        std::array<simd_type, max_sections> b0, b1, b2, a1, a2;
+    };
+
+    struct States
+    {
+        std::array<simd_type, max_sections> s1, s2;
+    };
+
+    // The active sections in processing order, with the slot id their state lives under
+    Coefficients coefficients;
+
+    // As designed, in double, so the time blocked form can be derived again in prepare
+    std::array<BiquadCoefficients, max_sections> sources;
+
+    std::array<int, max_sections> section_ids;
+    int num_sections{ 0 };
+
+    // Where each slot id sits in sections, -1 while it's inactive
+    std::array<int, max_sections> section_positions;
+
+    // The position each part starts at, then num_sections
+    std::array<int, num_parts + 1> part_starts{};
+
+    // Per lane group, indexed by slot id so a section keeps its state while others come and go
+    std::vector<States> states;
+
+    MultirateLowCut<SampleType> multirate_low_cut;
+
+    // One channel, num_lanes samples per register. Lane k of state1 and state2 is what s1 and
+    // s2 at the start of a block add to its output k, lane k of impulse[j] is h[k - j]
+    static constexpr size_t num_lanes = simd_type::size();
+    static_assert(num_lanes >= 2, "the state is carried over from the last two samples of a block");
+
+    struct TimeBlockCoefficients
+    {
+        std::array<simd_type, max_sections> state1, state2;
+        std::array<std::array<simd_type, max_sections>, num_lanes> impulse;
+        std::array<SampleType, max_sections> b0, b1, b2, a1, a2;
+    };
+
+    TimeBlockCoefficients time_block_coefficients;
+    lane_layout requested_layout{ lane_layout::automatic };
+    bool time_blocked{ false };
+
+    void set_time_block_section(int position) noexcept;
+    void process_time_blocks(SampleType* samples, size_t num_samples, States&, size_t lane, int first, int end) noexcept;
+
+    void set_section(int position, const BiquadCoefficients&) noexcept;
+    void clear_state(int id) noexcept;
+
+    // Each part runs positions starts[part] to starts[part + 1]
+    template <typename Callback>
+    void process_parts(const juce::dsp::AudioBlock<SampleType>&, const int* starts, int count, Callback&& on_part_done) noexcept;
+
+    // The sections at positions first to end
+    void process_group(simd_type* lanes, size_t num_samples, States&, int first, int end) noexcept;
+
+    // The fused loop for a fixed number of sections from first, on state already in processing order
+    using kernel = void (SIMDFilterChain::*)(simd_type* lanes, size_t num_samples, size_t first, States&) const noexcept;
+
+    template <size_t... counts>
+    static constexpr std::array<kernel, sizeof...(counts)> make_kernels(std::index_sequence<counts...>) noexcept
+    {
+        return { { &SIMDFilterChain::process_sections<counts + 1>... } };
+    }
+
+    template <size_t num_active>
+    void process_sections(simd_type* lanes, size_t num_samples, size_t first, States& local) const noexcept
+    {
+        process_sections(lanes, num_samples, first, local, std::make_index_sequence<num_active>());
+    }
+
+    template <size_t... index>
+    void process_sections(simd_type* lanes, size_t num_samples, size_t first, States&, std::index_sequence<index...>) const noexcept;
+
+    juce::HeapBlock<char> interleaved_data;
+    juce::dsp::AudioBlock<simd_type> interleaved;
+
+    void interleave(const juce::dsp::AudioBlock<SampleType>&, size_t first_channel, size_t num_samples) noexcept;
+    void deinterleave(const juce::dsp::AudioBlock<SampleType>&, size_t first_channel, size_t num_samples) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SIMDFilterChain)
+};
+
+template <typename SampleType>
+template <typename Callback>
+void SIMDFilterChain<SampleType>::process_parts(const juce::dsp::AudioBlock<SampleType>& block, const int* starts, int count, Callback&& on_part_done) noexcept
+{
+    jassert(block.getNumChannels() <= states.size() * get_num_lanes());
+
+    // Hosts should never exceed the prepared block size, but stay safe if one does
+    auto max_samples = interleaved.getNumSamples();
+    jassert(max_samples > 0);   // prepare() hasn't been called
+    if (max_samples == 0 || (num_sections == 0 && !multirate_low_cut.is_active()))
+        return;
+
+    if (time_blocked)
+    {
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            for (int part = 0; part < count; ++part)
+            {
+                process_time_blocks(block.getChannelPointer(channel), block.getNumSamples(), states[channel / get_num_lanes()], channel % get_num_lanes(),
+                                    starts[part], starts[part + 1]);
+                on_part_done(part);
+            }
+        }
+        return;
+    }
+
+    for (size_t start = 0; start < block.getNumSamples(); start += max_samples)
+    {
+        auto num_samples = juce::jmin(max_samples, block.getNumSamples() - start);
+        auto sub_block = block.getSubBlock(start, num_samples);
+
+        for (size_t group = 0; group < states.size(); ++group)
+        {
+            auto first_channel = group * get_num_lanes();
+            if (first_channel >= sub_block.getNumChannels())
+                break;
+
+            interleave(sub_block, first_channel, num_samples);
+            if (multirate_low_cut.is_active())
+                multirate_low_cut.process(interleaved.getChannelPointer(0), num_samples, group);
+
+            for (int part = 0; part < count; ++part)
+            {
+                process_group(interleaved.getChannelPointer(0), num_samples, states[group], starts[part], starts[part + 1]);
+                if (part + 1 < count)
+                    on_part_done(part);
+            }
+
+            deinterleave(sub_block, first_channel, num_samples);
+            on_part_done(count - 1);
+        }
+    }
+}
@@ -0,0 +1,159 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    The chain as topology preserving transform state variable filters.
+
+  ==============================================================================
+*/
+
+#include "SVFFilterChain.h"
+
+SVFSettings design_svf(const ChainSettings& chain_settings, double sample_rate) noexcept
+{
+    SVFSettings settings;
+    std::array<SVFSection, 4> cut;
+    auto num_low_cut_sections = make_svf_butterworth_cut(cut_type::high_pass, sample_rate, chain_settings.low_cut_freq, chain_settings.low_cut_slope, cut.data());
+
+    for (int i = 0; i < num_low_cut_sections; ++i)
+        settings.add(CoefficientSet::low_cut_id + i, cut[(size_t)i]);
+
+    for (int band = 0; band < num_bands; ++band)
+        if (chain_settings.bands[(size_t)band].is_active())
+            settings.add(CoefficientSet::first_band_id + band, make_svf_band(sample_rate, chain_settings.bands[(size_t)band]));
+
+    auto num_high_cut_sections = make_svf_butterworth_cut(cut_type::low_pass, sample_rate, chain_settings.high_cut_freq, chain_settings.high_cut_slope, cut.data());
+    for (int i = 0; i < num_high_cut_sections; ++i)
+        settings.add(CoefficientSet::high_cut_id + i, cut[(size_t)i]);
+
+    return settings;
+}
+
+//==============================================================================
+template <typename SampleType>
+void SVFFilterChain<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    jassert(spec.numChannels <= (juce::uint32)max_channels);
+    num_channels = juce::jmin((size_t)spec.numChannels, (size_t)max_channels);
+    reset();
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::reset() noexcept
+{
+    for (auto& channel : states)
+        channel.fill({});
+    current = target;
+    ramping = false;
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::update(const SVFSettings& settings) noexcept
+{
+    if (ramping)
+        current = target;
+
+    std::array<bool, max_sections> now_active{};
+    num_sections = settings.num_sections;
+    for (int i = 0; i < num_sections; ++i)
+    {
+        auto id = settings.ids[(size_t)i];
+        section_ids[(size_t)i] = id;
+        target[(size_t)id] = settings.sections[(size_t)i];
+        now_active[(size_t)id] = true;
+
+        // Slopes and bands switch straight away, a section that comes back starts from silence
+        if (!active[(size_t)id])
+        {
+            current[(size_t)id] = target[(size_t)id];
+            for (auto& channel : states)
+                channel[(size_t)id] = {};
+        }
+    }
+    active = now_active;
+
+    ramping = false;
+    for (int i = 0; i < num_sections; ++i)
+    {
+        auto& from = current[(size_t)section_ids[(size_t)i]];
+        auto& to = target[(size_t)section_ids[(size_t)i]];
+        ramping = ramping || from.g != to.g || from.k != to.k || from.m0 != to.m0 || from.m1 != to.m1 || from.m2 != to.m2;
+    }
+}
+
+template <typename SampleType>
+typename SVFFilterChain<SampleType>::Runtime SVFFilterChain<SampleType>::make_runtime(SampleType g, SampleType k, SampleType m0, SampleType m1, SampleType m2) noexcept
+{
+    auto a1 = 1 / (1 + g * (g + k));
+    auto a2 = g * a1;
+    return { a1, a2, g * a2, m0, m1, m2 };
+}
+
+template <typename SampleType>
+SampleType SVFFilterChain<SampleType>::tick(const Runtime& runtime, State& state, SampleType input) noexcept
+{
+    auto v3 = input - state.ic2eq;
+    auto v1 = runtime.a1 * state.ic1eq + runtime.a2 * v3;
+    auto v2 = state.ic2eq + runtime.a2 * state.ic1eq + runtime.a3 * v3;
+    state.ic1eq = 2 * v1 - state.ic1eq;
+    state.ic2eq = 2 * v2 - state.ic2eq;
+    return runtime.m0 * input + runtime.m1 * v1 + runtime.m2 * v2;
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    auto channels_to_process = juce::jmin(num_channels, block.getNumChannels());
+    auto num_samples = block.getNumSamples();
+    std::array<Runtime, max_sections> runtimes;
+
+    if (!ramping)
+    {
+        for (int i = 0; i < num_sections; ++i)
+        {
+            auto& section = current[(size_t)section_ids[(size_t)i]];
+            runtimes[(size_t)i] = make_runtime((SampleType)section.g, (SampleType)section.k, (SampleType)section.m0, (SampleType)section.m1, (SampleType)section.m2);
+        }
+
+        for (size_t channel = 0; channel < channels_to_process; ++channel)
+        {
+            auto* samples = block.getChannelPointer(channel);
+            auto& channel_states = states[channel];
+            for (size_t n = 0; n < num_samples; ++n)
+            {
+                auto sample = samples[n];
+                for (int i = 0; i < num_sections; ++i)
+                    sample = tick(runtimes[(size_t)i], channel_states[(size_t)section_ids[(size_t)i]], sample);
+                samples[n] = sample;
+            }
+        }
+        return;
+    }
+
+    // g, k and the mix move linearly towards the target, one redesign per sample shared by all channels
+    for (size_t n = 0; n < num_samples; ++n)
+    {
+        auto position = (SampleType)(n + 1) / (SampleType)num_samples;
+        auto ramp = [position](double from, double to) { return (SampleType)from + ((SampleType)to - (SampleType)from) * position; };
+        for (int i = 0; i < num_sections; ++i)
+        {
+            auto& from = current[(size_t)section_ids[(size_t)i]];
+            auto& to = target[(size_t)section_ids[(size_t)i]];
+            runtimes[(size_t)i] = make_runtime(ramp(from.g, to.g), ramp(from.k, to.k), ramp(from.m0, to.m0), ramp(from.m1, to.m1), ramp(from.m2, to.m2));
+        }
+
+        for (size_t channel = 0; channel < channels_to_process; ++channel)
+        {
+            auto& sample = block.getChannelPointer(channel)[n];
+            auto& channel_states = states[channel];
+            for (int i = 0; i < num_sections; ++i)
+                sample = tick(runtimes[(size_t)i], channel_states[(size_t)section_ids[(size_t)i]], sample);
+        }
+    }
+
+    current = target;
+    ramping = false;
+}
+
+template class SVFFilterChain<float>;
+template class SVFFilterChain<double>;
@@ -0,0 +1,140 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    The chain as topology preserving transform state variable filters.
+
+    Each section is a trapezoidal SVF (Zavalishin, Simper) with its output
+    taken as m0 * input + m1 * band + m2 * low. Designing one is a single
+    tan() plus a few multiplies and no heap objects, and the structure stays
+    stable however fast g and k move, so the sections are ramped per sample
+    towards each update instead of jumping. The responses are the same
+    prewarped bilinear ones as the biquad designs in BiquadDesign.h.
+
+    Sections are designed in double like the biquads and the chain is
+    instantiated for float and double processing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "BiquadDesign.h"
+#include "FilterDesigner.h"
+
+struct SVFSection
+{
+    double g{ 0.0 }, k{ 1.0 }, m0{ 1.0 }, m1{ 0.0 }, m2{ 0.0 };
+};
+
+// Active sections only, with the same slot ids as CoefficientSet
+struct SVFSettings
+{
+    std::array<SVFSection, CoefficientSet::max_sections> sections;
+    std::array<int, CoefficientSet::max_sections> ids;
+    int num_sections{ 0 };
+
+    void add(int id, const SVFSection& section) noexcept
+    {
+        jassert(num_sections < CoefficientSet::max_sections);
+        ids[(size_t)num_sections] = id;
+        sections[(size_t)num_sections++] = section;
+    }
+};
+
+inline SVFSection make_svf_band(double sample_rate, const BandSettings& band) noexcept
+{
+    auto A = std::sqrt(juce::Decibels::decibelsToGain((double)band.gain_in_decibels));
+    auto g = std::tan(juce::MathConstants<double>::pi * juce::jmax(band.freq, 2.f) / sample_rate);
+    auto k = 1 / (double)juce::jmax(band.quality, 0.01f);
+
+    switch (band.type)
+    {
+        case band_type::low_shelf:  return { g / std::sqrt(A), k, 1.0, k * (A - 1), A * A - 1 };
+        case band_type::high_shelf: return { g * std::sqrt(A), k, A * A, k * (1 - A) * A, 1 - A * A };
+        case band_type::notch:      return { g, k, 1.0, -k, 0.0 };
+        case band_type::peak:       break;
+    }
+
+    k /= A;
+    return { g, k, 1.0, k * (A * A - 1), 0.0 };
+}
+
+// Butterworth cut of 12 * num_sections dB/Oct, all sections share one tan()
+template <cut_type type, int num_sections>
+inline int make_svf_butterworth_cut(double sample_rate, float frequency, SVFSection* sections) noexcept
+{
+    auto g = std::tan(juce::MathConstants<double>::pi * get_cut_frequency(sample_rate, frequency) / sample_rate);
+
+    for (int i = 0; i < num_sections; ++i)
+    {
+        auto k = 1 / butterworth_section_q[num_sections - 1][i];
+        sections[i] = type == cut_type::high_pass ? SVFSection{ g, k, 1.0, -k, -1.0 } : SVFSection{ g, k, 0.0, 0.0, 1.0 };
+    }
+
+    return num_sections;
+}
+
+inline int make_svf_butterworth_cut(cut_type type, double sample_rate, float frequency, slope cut_slope, SVFSection* sections) noexcept
+{
+    return dispatch_cut_slope(cut_slope, [&](auto num_sections)
+    {
+        constexpr int count = decltype(num_sections)::value;
+        return type == cut_type::high_pass ? make_svf_butterworth_cut<cut_type::high_pass, count>(sample_rate, frequency, sections)
+                                           : make_svf_butterworth_cut<cut_type::low_pass, count>(sample_rate, frequency, sections);
+    });
+}
+
+SVFSettings design_svf(const ChainSettings&, double sample_rate) noexcept;
+
+//==============================================================================
+template <typename SampleType>
+class SVFFilterChain
+{
+public:
+    SVFFilterChain() = default;
+
+    static constexpr int max_channels = 16;
+
+    void prepare(const juce::dsp::ProcessSpec&);
+    void reset() noexcept;
+
+    // Ramps every section from where it is now to these settings over the next process call
+    void update(const SVFSettings&) noexcept;
+
+    // Processes up to the prepared number of channels in place
+    void process(const juce::dsp::AudioBlock<SampleType>&) noexcept;
+
+private:
+    static constexpr int max_sections = CoefficientSet::max_sections;
+
+    struct State
+    {
+        SampleType ic1eq{ 0 }, ic2eq{ 0 };
+    };
+
+    // The per sample form of a section, a1 = 1 / (1 + g (g + k)) is what a redesign costs
+    struct Runtime
+    {
+        SampleType a1, a2, a3, m0, m1, m2;
+    };
+
+    static Runtime make_runtime(SampleType g, SampleType k, SampleType m0, SampleType m1, SampleType m2) noexcept;
+    static SampleType tick(const Runtime&, State&, SampleType input) noexcept;
+
+    // Indexed by slot id
+    std::array<SVFSection, max_sections> current, target;
+    std::array<bool, max_sections> active{};
+    bool ramping{ false };
+
+    // The active ids in processing order
+    std::array<int, max_sections> section_ids;
+    int num_sections{ 0 };
+
+    std::array<std::array<State, max_sections>, max_channels> states;
+    size_t num_channels{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SVFFilterChain)
+};
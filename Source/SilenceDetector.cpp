@@ -0,0 +1,53 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Puts an instance to sleep while its input is silent and its tail is done.
+
+  ==============================================================================
+*/
+
+#include "SilenceDetector.h"
+
+void SilenceDetector::reset() noexcept
+{
+    silent_samples = 0;
+    sleeping = false;
+}
+
+template <typename SampleType>
+SampleType SilenceDetector::get_peak(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    auto range = block.findMinAndMax();
+    return juce::jmax(-range.getStart(), range.getEnd());
+}
+
+template <typename SampleType>
+bool SilenceDetector::process_input(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    if (get_peak(block) > (SampleType)threshold)
+    {
+        silent_samples = 0;
+        sleeping = false;
+        return false;
+    }
+
+    silent_samples += (juce::int64)block.getNumSamples();
+    return sleeping;
+}
+
+template <typename SampleType>
+bool SilenceDetector::process_output(const juce::dsp::AudioBlock<SampleType>& block, int tail_samples) noexcept
+{
+    // The tail bound covers the slowest pole, the output check catches anything it doesn't
+    if (sleeping || silent_samples < (juce::int64)tail_samples || get_peak(block) > (SampleType)threshold)
+        return false;
+
+    sleeping = true;
+    return true;
+}
+
+template bool SilenceDetector::process_input(const juce::dsp::AudioBlock<float>&) noexcept;
+template bool SilenceDetector::process_input(const juce::dsp::AudioBlock<double>&) noexcept;
+template bool SilenceDetector::process_output(const juce::dsp::AudioBlock<float>&, int) noexcept;
+template bool SilenceDetector::process_output(const juce::dsp::AudioBlock<double>&, int) noexcept;
@@ -0,0 +1,49 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Puts an instance to sleep while its input is silent and its tail is done.
+
+    The input peak is checked before every block. Once it has stayed below
+    the threshold for at least the tail length of the active cascade and the
+    last output block was below it too, the filters are reset and processing
+    is skipped. The first block that carries signal again wakes it up and is
+    processed normally, so waking never costs more than the block itself.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class SilenceDetector
+{
+public:
+    SilenceDetector() = default;
+
+    // -120 dBFS, the same level the tail length is measured down to
+    static constexpr float threshold = 1.0e-6f;
+    static constexpr double threshold_in_decibels = -120.0;
+
+    void reset() noexcept;
+
+    // Before processing: true if the block can be skipped because the instance is asleep
+    template <typename SampleType>
+    bool process_input(const juce::dsp::AudioBlock<SampleType>&) noexcept;
+
+    // After processing: true if the instance has just gone to sleep, so the filter state should be cleared
+    template <typename SampleType>
+    bool process_output(const juce::dsp::AudioBlock<SampleType>&, int tail_samples) noexcept;
+
+    bool is_sleeping() const noexcept { return sleeping; }
+
+private:
+    template <typename SampleType>
+    static SampleType get_peak(const juce::dsp::AudioBlock<SampleType>&) noexcept;
+
+    juce::int64 silent_samples{ 0 };
+    bool sleeping{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SilenceDetector)
+};
@@ -0,0 +1,348 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Snapshots of the chain settings, each kept next to its designed
+    coefficient set.
+
+  ==============================================================================
+*/
+
+#include "SnapshotBank.h"
+
+namespace
+{
+    // One section as its numerator and the reflection coefficients of 1 + a1 z^-1 + a2 z^-2.
+    // The section is stable exactly when both k lie in (-1, 1), a square, so any
+    // straight line between two stable sections stays stable
+    struct LatticeSection
+    {
+        double b0, b1, b2, k1, k2;
+    };
+
+    LatticeSection to_lattice(const BiquadCoefficients& c) noexcept
+    {
+        return { c.b0, c.b1, c.b2, c.a1 / (1.0 + c.a2), c.a2 };
+    }
+
+    BiquadCoefficients interpolate(const BiquadCoefficients& from, const BiquadCoefficients& to, double amount) noexcept
+    {
+        auto a = to_lattice(from);
+        auto b = to_lattice(to);
+        auto k1 = a.k1 + (b.k1 - a.k1) * amount;
+        auto k2 = a.k2 + (b.k2 - a.k2) * amount;
+
+        return { a.b0 + (b.b0 - a.b0) * amount,
+                 a.b1 + (b.b1 - a.b1) * amount,
+                 a.b2 + (b.b2 - a.b2) * amount,
+                 k1 * (1.0 + k2),
+                 k2 };
+    }
+
+    const juce::Identifier snapshot_type{ "Snapshot" }, parameter_type{ "PARAM" };
+    const juce::Identifier name_property{ "name" }, id_property{ "id" }, value_property{ "value" };
+
+    // Same layout as the parameters in the APVTS state, one PARAM child per value
+    void write_settings(juce::ValueTree& tree, const ChainSettings& chain_settings)
+    {
+        auto add = [&tree](const juce::String& parameter_id, float value)
+        {
+            juce::ValueTree parameter(parameter_type);
+            parameter.setProperty(id_property, parameter_id, nullptr);
+            parameter.setProperty(value_property, value, nullptr);
+            tree.appendChild(parameter, nullptr);
+        };
+
+        add(LOW_CUT_FREQ, chain_settings.low_cut_freq);
+        add(HIGH_CUT_FREQ, chain_settings.high_cut_freq);
+        for (int band = 0; band < num_bands; ++band)
+        {
+            auto& band_settings = chain_settings.bands[(size_t)band];
+            add(get_band_parameter_id(band, BAND_FREQ), band_settings.freq);
+            add(get_band_parameter_id(band, BAND_GAIN), band_settings.gain_in_decibels);
+            add(get_band_parameter_id(band, BAND_QUALITY), band_settings.quality);
+            add(get_band_parameter_id(band, BAND_TYPE), (float)band_settings.type);
+        }
+        add(LOW_CUT_SLOPE, (float)chain_settings.low_cut_slope);
+        add(HIGH_CUT_SLOPE, (float)chain_settings.high_cut_slope);
+        add(DESIGN_MODE, (float)chain_settings.filter_design);
+    }
+
+    // Values missing from the tree keep what chain_settings already holds
+    void read_settings(const juce::ValueTree& tree, ChainSettings& chain_settings)
+    {
+        auto read = [&tree](const juce::String& parameter_id, float value)
+        {
+            auto parameter = tree.getChildWithProperty(id_property, parameter_id);
+            return parameter.isValid() ? (float)parameter.getProperty(value_property, value) : value;
+        };
+
+        chain_settings.low_cut_freq = read(LOW_CUT_FREQ, chain_settings.low_cut_freq);
+        chain_settings.high_cut_freq = read(HIGH_CUT_FREQ, chain_settings.high_cut_freq);
+        for (int band = 0; band < num_bands; ++band)
+        {
+            auto& band_settings = chain_settings.bands[(size_t)band];
+            band_settings.freq = read(get_band_parameter_id(band, BAND_FREQ), band_settings.freq);
+            band_settings.gain_in_decibels = read(get_band_parameter_id(band, BAND_GAIN), band_settings.gain_in_decibels);
+            band_settings.quality = read(get_band_parameter_id(band, BAND_QUALITY), band_settings.quality);
+            band_settings.type = static_cast<band_type>(read(get_band_parameter_id(band, BAND_TYPE), (float)band_settings.type));
+        }
+        chain_settings.low_cut_slope = static_cast<slope>(read(LOW_CUT_SLOPE, (float)chain_settings.low_cut_slope));
+        chain_settings.high_cut_slope = static_cast<slope>(read(HIGH_CUT_SLOPE, (float)chain_settings.high_cut_slope));
+        chain_settings.filter_design = static_cast<design_mode>(read(DESIGN_MODE, (float)chain_settings.filter_design));
+    }
+
+    // The same values in the same order, for the binary state
+    constexpr int num_setting_values = 2 + 4 * num_bands + 3;
+
+    std::array<float, num_setting_values> get_setting_values(const ChainSettings& chain_settings) noexcept
+    {
+        std::array<float, num_setting_values> values;
+        auto* value = values.data();
+        *value++ = chain_settings.low_cut_freq;
+        *value++ = chain_settings.high_cut_freq;
+        for (auto& band_settings : chain_settings.bands)
+        {
+            *value++ = band_settings.freq;
+            *value++ = band_settings.gain_in_decibels;
+            *value++ = band_settings.quality;
+            *value++ = (float)band_settings.type;
+        }
+        *value++ = (float)chain_settings.low_cut_slope;
+        *value++ = (float)chain_settings.high_cut_slope;
+        *value = (float)chain_settings.filter_design;
+        return values;
+    }
+
+    void set_setting_values(ChainSettings& chain_settings, const std::array<float, num_setting_values>& values) noexcept
+    {
+        auto* value = values.data();
+        chain_settings.low_cut_freq = *value++;
+        chain_settings.high_cut_freq = *value++;
+        for (auto& band_settings : chain_settings.bands)
+        {
+            band_settings.freq = *value++;
+            band_settings.gain_in_decibels = *value++;
+            band_settings.quality = *value++;
+            band_settings.type = static_cast<band_type>(juce::jlimit(0, 3, juce::roundToInt(*value++)));
+        }
+        chain_settings.low_cut_slope = static_cast<slope>(juce::jlimit(0, 3, juce::roundToInt(*value++)));
+        chain_settings.high_cut_slope = static_cast<slope>(juce::jlimit(0, 3, juce::roundToInt(*value++)));
+        chain_settings.filter_design = static_cast<design_mode>(juce::jlimit(0, 1, juce::roundToInt(*value)));
+    }
+}
+
+CoefficientSet morph_coefficients(const CoefficientSet& from, const CoefficientSet& to, double amount) noexcept
+{
+    // Both sets list their sections in ascending id order, so this is a merge
+    static const BiquadCoefficients unity;
+    CoefficientSet coefficient_set;
+    int i = 0, j = 0;
+    while (i < from.num_sections || j < to.num_sections)
+    {
+        auto from_id = i < from.num_sections ? from.ids[(size_t)i] : CoefficientSet::max_sections;
+        auto to_id = j < to.num_sections ? to.ids[(size_t)j] : CoefficientSet::max_sections;
+        auto id = juce::jmin(from_id, to_id);
+
+        auto& from_section = from_id == id ? from.sections[(size_t)i++] : unity;
+        auto& to_section = to_id == id ? to.sections[(size_t)j++] : unity;
+        coefficient_set.add(id, interpolate(from_section, to_section, amount));
+    }
+
+    return coefficient_set;
+}
+
+//==============================================================================
+const juce::Identifier SnapshotBank::state_type{ "Snapshots" };
+
+SnapshotBank::SnapshotBank()
+{
+    for (int i = 0; i < num_snapshots; ++i)
+        slots[(size_t)i].name = "Snapshot " + juce::String(i + 1);
+}
+
+void SnapshotBank::initialise(const ChainSettings& chain_settings)
+{
+    for (auto& slot : slots)
+        design(slot, chain_settings);
+}
+
+void SnapshotBank::prepare(double sample_rate)
+{
+    // Every store and restore designs for the current rate already
+    if (sample_rate == current_sample_rate)
+        return;
+
+    current_sample_rate = sample_rate;
+    for (auto& slot : slots)
+    {
+        ChainSettings chain_settings;
+        {
+            const juce::SpinLock::ScopedLockType lock(slot.lock);
+            chain_settings = slot.settings;
+        }
+        design(slot, chain_settings);
+    }
+}
+
+void SnapshotBank::store(int index, const ChainSettings& chain_settings)
+{
+    if (juce::isPositiveAndBelow(index, num_snapshots))
+        design(slots[(size_t)index], chain_settings);
+}
+
+void SnapshotBank::get(int index, ChainSettings& chain_settings, CoefficientSet& coefficient_set, double& sample_rate) const
+{
+    auto& slot = slots[(size_t)juce::jlimit(0, num_snapshots - 1, index)];
+    const juce::SpinLock::ScopedLockType lock(slot.lock);
+    chain_settings = slot.settings;
+    coefficient_set = slot.coefficients;
+    sample_rate = current_sample_rate;
+}
+
+juce::String SnapshotBank::get_name(int index) const
+{
+    return juce::isPositiveAndBelow(index, num_snapshots) ? slots[(size_t)index].name : juce::String();
+}
+
+void SnapshotBank::set_name(int index, const juce::String& name)
+{
+    if (juce::isPositiveAndBelow(index, num_snapshots))
+        slots[(size_t)index].name = name;
+}
+
+bool SnapshotBank::read(int index, CoefficientSet& coefficient_set, juce::uint32& version) const noexcept
+{
+    auto& slot = slots[(size_t)juce::jlimit(0, num_snapshots - 1, index)];
+    if (slot.version.load() == version)
+        return true;
+
+    const juce::SpinLock::ScopedTryLockType lock(slot.lock);
+    if (!lock.isLocked())
+        return false;
+
+    coefficient_set = slot.coefficients;
+    version = slot.version.load();
+    return true;
+}
+
+juce::ValueTree SnapshotBank::to_value_tree() const
+{
+    juce::ValueTree tree(state_type);
+    for (auto& slot : slots)
+    {
+        juce::ValueTree snapshot(snapshot_type);
+        snapshot.setProperty(name_property, slot.name, nullptr);
+        {
+            const juce::SpinLock::ScopedLockType lock(slot.lock);
+            write_settings(snapshot, slot.settings);
+        }
+        tree.appendChild(snapshot, nullptr);
+    }
+
+    return tree;
+}
+
+void SnapshotBank::from_value_tree(const juce::ValueTree& tree)
+{
+    for (int i = 0; i < juce::jmin(num_snapshots, tree.getNumChildren()); ++i)
+    {
+        auto snapshot = tree.getChild(i);
+        auto& slot = slots[(size_t)i];
+        slot.name = snapshot.getProperty(name_property, slot.name);
+
+        ChainSettings chain_settings;
+        {
+            const juce::SpinLock::ScopedLockType lock(slot.lock);
+            chain_settings = slot.settings;
+        }
+        read_settings(snapshot, chain_settings);
+        design(slot, chain_settings);
+    }
+}
+
+void SnapshotBank::write_binary(juce::OutputStream& stream) const
+{
+    stream.writeInt(num_snapshots);
+    for (auto& slot : slots)
+    {
+        std::array<float, num_setting_values> values;
+        {
+            const juce::SpinLock::ScopedLockType lock(slot.lock);
+            values = get_setting_values(slot.settings);
+        }
+
+        stream.writeString(slot.name);
+        stream.writeInt(num_setting_values);
+        for (auto value : values)
+            stream.writeFloat(value);
+    }
+}
+
+bool SnapshotBank::read_binary(juce::InputStream& stream)
+{
+    struct StoredSlot
+    {
+        juce::String name;
+        std::array<float, num_setting_values> values;
+        int num_values;
+    };
+
+    auto num_stored = stream.readInt();
+    if (num_stored < 0)
+        return false;
+
+    std::vector<StoredSlot> stored;
+    for (int i = 0; i < num_stored; ++i)
+    {
+        if (stream.isExhausted())
+            return false;
+
+        StoredSlot slot;
+        slot.name = stream.readString();
+        auto num_values = stream.readInt();
+        if (num_values < 0 || stream.getNumBytesRemaining() < (juce::int64)num_values * 4)
+            return false;
+
+        slot.num_values = juce::jmin(num_values, num_setting_values);
+        for (int j = 0; j < num_values; ++j)
+        {
+            auto value = stream.readFloat();
+            if (j < slot.num_values)
+                slot.values[(size_t)j] = value;
+        }
+
+        if (i < num_snapshots)
+            stored.push_back(slot);
+    }
+
+    for (size_t i = 0; i < stored.size(); ++i)
+    {
+        auto& slot = slots[i];
+        slot.name = stored[i].name;
+
+        // Values an older layout didn't have keep what the slot holds
+        ChainSettings chain_settings;
+        {
+            const juce::SpinLock::ScopedLockType lock(slot.lock);
+            chain_settings = slot.settings;
+        }
+        auto values = get_setting_values(chain_settings);
+        std::copy(stored[i].values.begin(), stored[i].values.begin() + stored[i].num_values, values.begin());
+        set_setting_values(chain_settings, values);
+        design(slot, chain_settings);
+    }
+
+    return true;
+}
+
+void SnapshotBank::design(Slot& slot, const ChainSettings& chain_settings)
+{
+    // Designed before taking the lock, so the audio thread only ever misses a copy, never waits for a design
+    auto coefficient_set = current_sample_rate > 0.0 ? design_coefficients(chain_settings, current_sample_rate, *coefficient_cache) : CoefficientSet();
+
+    const juce::SpinLock::ScopedLockType lock(slot.lock);
+    slot.settings = chain_settings;
+    slot.coefficients = coefficient_set;
+    ++slot.version;
+}
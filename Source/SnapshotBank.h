@@ -0,0 +1,83 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Snapshots of the chain settings, each kept next to its designed
+    coefficient set.
+
+    Every slot is designed on the message thread when it's stored or
+    restored and again when the sample rate changes, so recalling one is a
+    copy and morphing between two is an interpolation of sets that already
+    exist. The audio thread only ever try-locks a slot, if a store is in
+    progress it keeps the copy it already has.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "FilterDesigner.h"
+
+// Interpolates two sets section by section, matched by id. The poles move through
+// the reflection coefficients, which stay inside the stable region for any amount
+// in 0..1. A section only one side has is faded from or to unity
+CoefficientSet morph_coefficients(const CoefficientSet& from, const CoefficientSet& to, double amount) noexcept;
+
+class SnapshotBank
+{
+public:
+    static constexpr int num_snapshots = 8;
+
+    SnapshotBank();
+
+    // Message thread: every slot starts out as these settings
+    void initialise(const ChainSettings&);
+
+    // Message thread: redesigns every slot for the new sample rate
+    void prepare(double sample_rate);
+
+    // Message thread
+    void store(int index, const ChainSettings&);
+
+    // Any thread, only copies under the slot's spin lock
+    void get(int index, ChainSettings&, CoefficientSet&, double& sample_rate) const;
+    juce::String get_name(int index) const;
+    void set_name(int index, const juce::String&);
+
+    // Audio thread: copies the slot's set if it changed since version. Returns false
+    // while the slot is being stored, coefficient_set and version are left as they were
+    bool read(int index, CoefficientSet&, juce::uint32& version) const noexcept;
+
+    // Saved as a child of the plugin state by every build before the binary format
+    static const juce::Identifier state_type;
+    juce::ValueTree to_value_tree() const;
+    void from_value_tree(const juce::ValueTree&);
+
+    // The binary state's part: the number of slots, then each slot's name and the
+    // number of its values, followed by the values in write_settings' order.
+    // read_binary returns false, without touching any slot, if the stream ends early
+    void write_binary(juce::OutputStream&) const;
+    bool read_binary(juce::InputStream&);
+
+private:
+    struct Slot
+    {
+        mutable juce::SpinLock lock;
+        juce::String name;
+        ChainSettings settings;
+        CoefficientSet coefficients;
+        std::atomic<juce::uint32> version{ 1 };
+    };
+
+    std::array<Slot, num_snapshots> slots;
+    double current_sample_rate{ 0.0 };
+
+    // Slots often hold the same or similar settings, and other instances the same again
+    juce::SharedResourcePointer<CoefficientCache> coefficient_cache;
+
+    void design(Slot&, const ChainSettings&);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SnapshotBank)
+};
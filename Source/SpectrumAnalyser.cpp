@@ -0,0 +1,236 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Pre and post EQ spectrum analysis for the editor's response area.
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyser.h"
+
+SpectrumAnalyser::SpectrumAnalyser()
+    : juce::Thread("SEQ Spectrum Analyser")
+{
+    prepare(44100.0, 512);
+}
+
+SpectrumAnalyser::~SpectrumAnalyser()
+{
+    stopThread(1000);
+}
+
+void SpectrumAnalyser::prepare(double sample_rate, int maximum_block_size)
+{
+    // The analysis thread reads everything below, so it sits this out
+    const juce::ScopedLock lock(thread_lock);
+    stopThread(1000);
+
+    mixdown.resize((size_t)juce::jmax(1, maximum_block_size));
+
+    // Each display point takes the loudest FFT bin between its neighbours' log frequencies
+    for (int point = 0; point <= num_points; ++point)
+    {
+        auto frequency = 20.0 * std::pow(1000.0, (point - 0.5) / (num_points - 1));
+        bin_edges[(size_t)point] = juce::jlimit(1, fft_size / 2, juce::roundToInt(frequency * fft_size / sample_rate));
+    }
+
+    pre.reset();
+    post.reset();
+
+    if (enabled.load())
+        startThread();
+}
+
+void SpectrumAnalyser::set_enabled(bool should_be_enabled)
+{
+    const juce::ScopedLock lock(thread_lock);
+    if (should_be_enabled == enabled.load())
+        return;
+
+    if (should_be_enabled)
+    {
+        pre.reset();
+        post.reset();
+        enabled = true;
+        startThread();
+    }
+    else
+    {
+        enabled = false;
+        stopThread(1000);
+    }
+}
+
+template <typename SampleType>
+void SpectrumAnalyser::push_pre(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    if (enabled.load(std::memory_order_relaxed))
+        pre.push(block, mixdown);
+}
+
+template <typename SampleType>
+void SpectrumAnalyser::push_post(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    if (enabled.load(std::memory_order_relaxed))
+        post.push(block, mixdown);
+}
+
+template <typename SampleType>
+void SpectrumAnalyser::Stream::push(const juce::dsp::AudioBlock<SampleType>& block, std::vector<float>& scratch) noexcept
+{
+    auto num_channels = block.getNumChannels();
+    if (num_channels == 0)
+        return;
+
+    auto gain = 1.f / (float)num_channels;
+    for (size_t start = 0; start < block.getNumSamples(); start += scratch.size())
+    {
+        auto num_samples = (int)juce::jmin(scratch.size(), block.getNumSamples() - start);
+
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            juce::FloatVectorOperations::copyWithMultiply(scratch.data(), block.getChannelPointer(0) + start, gain, num_samples);
+            for (size_t channel = 1; channel < num_channels; ++channel)
+                juce::FloatVectorOperations::addWithMultiply(scratch.data(), block.getChannelPointer(channel) + start, gain, num_samples);
+        }
+        else
+        {
+            // The analyser only needs float, the double block is rounded as it's mixed down
+            std::fill(scratch.begin(), scratch.begin() + num_samples, 0.f);
+            for (size_t channel = 0; channel < num_channels; ++channel)
+            {
+                auto* source = block.getChannelPointer(channel) + start;
+                for (int i = 0; i < num_samples; ++i)
+                    scratch[(size_t)i] += gain * (float)source[i];
+            }
+        }
+
+        // Whatever doesn't fit is dropped, the audio thread never waits for the analyser
+        const auto scope = fifo.write(num_samples);
+        if (scope.blockSize1 > 0)
+            std::copy(scratch.data(), scratch.data() + scope.blockSize1, fifo_data.data() + scope.startIndex1);
+        if (scope.blockSize2 > 0)
+            std::copy(scratch.data() + scope.blockSize1, scratch.data() + scope.blockSize1 + scope.blockSize2, fifo_data.data() + scope.startIndex2);
+    }
+}
+
+template void SpectrumAnalyser::push_pre(const juce::dsp::AudioBlock<float>&) noexcept;
+template void SpectrumAnalyser::push_pre(const juce::dsp::AudioBlock<double>&) noexcept;
+template void SpectrumAnalyser::push_post(const juce::dsp::AudioBlock<float>&) noexcept;
+template void SpectrumAnalyser::push_post(const juce::dsp::AudioBlock<double>&) noexcept;
+
+bool SpectrumAnalyser::Stream::collect() noexcept
+{
+    const auto scope = fifo.read(fifo.getNumReady());
+    auto copy_to_history = [this](int start, int size)
+    {
+        for (int i = 0; i < size; ++i)
+        {
+            history[(size_t)history_position] = fifo_data[(size_t)(start + i)];
+            history_position = (history_position + 1) % fft_size;
+        }
+    };
+    copy_to_history(scope.startIndex1, scope.blockSize1);
+    copy_to_history(scope.startIndex2, scope.blockSize2);
+
+    // However far behind we are, only the newest window gets analysed
+    num_new_samples += scope.blockSize1 + scope.blockSize2;
+    if (num_new_samples < hop_size)
+        return false;
+
+    num_new_samples = 0;
+    return true;
+}
+
+void SpectrumAnalyser::Stream::reset() noexcept
+{
+    fifo.reset();
+    history.fill(0.f);
+    history_position = 0;
+    num_new_samples = 0;
+    levels.fill(min_decibels);
+    peaks.fill(min_decibels);
+}
+
+void SpectrumAnalyser::run()
+{
+    while (!threadShouldExit())
+    {
+        auto pre_updated = pre.collect();
+        auto post_updated = post.collect();
+
+        if (pre_updated)
+            analyse(pre);
+        if (post_updated)
+            analyse(post);
+
+        if (pre_updated || post_updated)
+        {
+            auto new_pre = make_path(pre.levels);
+            auto new_post = make_path(post.levels);
+            auto new_peak = make_path(post.peaks);
+
+            const juce::SpinLock::ScopedLockType lock(path_lock);
+            pre_path.swapWithPath(new_pre);
+            post_path.swapWithPath(new_post);
+            post_peak_path.swapWithPath(new_peak);
+        }
+
+        wait(15);
+    }
+}
+
+void SpectrumAnalyser::analyse(Stream& stream)
+{
+    // Unroll the circular history so the window starts at the oldest sample
+    for (int i = 0; i < fft_size; ++i)
+        fft_data[(size_t)i] = stream.history[(size_t)((stream.history_position + i) % fft_size)];
+    std::fill(fft_data.begin() + fft_size, fft_data.end(), 0.f);
+
+    window.multiplyWithWindowingTable(fft_data.data(), (size_t)fft_size);
+    fft.performFrequencyOnlyForwardTransform(fft_data.data(), true);
+
+    constexpr float release = 0.25f, peak_decay_decibels = 0.5f;
+    for (int point = 0; point < num_points; ++point)
+    {
+        auto first_bin = bin_edges[(size_t)point];
+        auto last_bin = juce::jmax(first_bin + 1, bin_edges[(size_t)point + 1]);
+
+        auto magnitude = 0.f;
+        for (int bin = first_bin; bin < last_bin && bin <= fft_size / 2; ++bin)
+            magnitude = juce::jmax(magnitude, fft_data[(size_t)bin]);
+
+        auto decibels = juce::jlimit(min_decibels, max_decibels, juce::Decibels::gainToDecibels(magnitude * 2.f / fft_size, min_decibels));
+
+        auto& level = stream.levels[(size_t)point];
+        level = decibels > level ? decibels : level + (decibels - level) * release;
+
+        auto& peak = stream.peaks[(size_t)point];
+        peak = juce::jmax(level, peak - peak_decay_decibels);
+    }
+}
+
+juce::Path SpectrumAnalyser::make_path(const std::array<float, num_points>& decibels) const
+{
+    juce::Path path;
+    path.preallocateSpace(num_points * 3);
+    for (int point = 0; point < num_points; ++point)
+    {
+        auto x = (float)point / (num_points - 1);
+        auto y = juce::jmap(decibels[(size_t)point], max_decibels, min_decibels, 0.f, 1.f);
+        if (point == 0)
+            path.startNewSubPath(x, y);
+        else
+            path.lineTo(x, y);
+    }
+    return path;
+}
+
+void SpectrumAnalyser::get_paths(juce::Path& pre_spectrum, juce::Path& post_spectrum, juce::Path& post_peak_hold) const
+{
+    const juce::SpinLock::ScopedLockType lock(path_lock);
+    pre_spectrum = pre_path;
+    post_spectrum = post_path;
+    post_peak_hold = post_peak_path;
+}
@@ -0,0 +1,82 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Pre and post EQ spectrum analysis for the editor's response area.
+
+    The audio thread only mixes each block down to mono and copies it into a
+    lock-free AbstractFifo, dropping samples rather than ever waiting. A
+    background thread runs the windowed FFTs, bins them onto a log frequency
+    axis with peak-hold and builds the paths, which the editor just copies
+    and paints. While no editor is open the thread is stopped and pushing is
+    a single atomic load.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class SpectrumAnalyser : private juce::Thread
+{
+public:
+    SpectrumAnalyser();
+    ~SpectrumAnalyser() override;
+
+    void prepare(double sample_rate, int maximum_block_size);
+
+    // Message thread: the editor turns analysis on while it is open
+    void set_enabled(bool);
+
+    // Audio thread
+    template <typename SampleType>
+    void push_pre(const juce::dsp::AudioBlock<SampleType>&) noexcept;
+    template <typename SampleType>
+    void push_post(const juce::dsp::AudioBlock<SampleType>&) noexcept;
+
+    // Message thread: paths in normalised coordinates, x from 20 Hz to 20 kHz
+    // on a log axis, y from max_decibels (0) down to min_decibels (1)
+    void get_paths(juce::Path& pre, juce::Path& post, juce::Path& post_peak_hold) const;
+
+    static constexpr float min_decibels = -96.f, max_decibels = 6.f;
+
+private:
+    static constexpr int fft_order = 11, fft_size = 1 << fft_order, hop_size = fft_size / 2;
+    static constexpr int num_points = 256, fifo_size = 1 << 15;
+
+    struct Stream
+    {
+        juce::AbstractFifo fifo{ fifo_size };
+        std::vector<float> fifo_data = std::vector<float>((size_t)fifo_size);
+
+        std::array<float, fft_size> history{};
+        int history_position{ 0 }, num_new_samples{ 0 };
+
+        std::array<float, num_points> levels, peaks;
+
+        template <typename SampleType>
+        void push(const juce::dsp::AudioBlock<SampleType>&, std::vector<float>& mixdown) noexcept;
+        bool collect() noexcept;
+        void reset() noexcept;
+    };
+
+    void run() override;
+    void analyse(Stream&);
+    juce::Path make_path(const std::array<float, num_points>&) const;
+
+    juce::CriticalSection thread_lock;
+    std::atomic<bool> enabled{ false };
+    Stream pre, post;
+    std::vector<float> mixdown;
+
+    juce::dsp::FFT fft{ fft_order };
+    juce::dsp::WindowingFunction<float> window{ (size_t)fft_size, juce::dsp::WindowingFunction<float>::hann };
+    std::array<float, fft_size * 2> fft_data;
+    std::array<int, num_points + 1> bin_edges;
+
+    juce::SpinLock path_lock;
+    juce::Path pre_path, post_path, post_peak_path;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyser)
+};
@@ -0,0 +1,46 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Draws the pre and post EQ spectrum behind the response area.
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyserComponent.h"
+
+SpectrumAnalyserComponent::SpectrumAnalyserComponent(SpectrumAnalyser& spectrum_analyser)
+    : analyser(spectrum_analyser)
+{
+    setInterceptsMouseClicks(false, false);
+    analyser.set_enabled(true);
+    startTimerHz(30);
+}
+
+SpectrumAnalyserComponent::~SpectrumAnalyserComponent()
+{
+    stopTimer();
+    analyser.set_enabled(false);
+}
+
+void SpectrumAnalyserComponent::timerCallback()
+{
+    analyser.get_paths(pre_spectrum, post_spectrum, post_peak_hold);
+    repaint();
+}
+
+void SpectrumAnalyserComponent::paint(juce::Graphics& g)
+{
+    // The analyser builds its paths in a unit square, scaling them is all that's left to do here
+    auto bounds = getLocalBounds().toFloat();
+    auto to_bounds = juce::AffineTransform::scale(bounds.getWidth(), bounds.getHeight()).translated(bounds.getX(), bounds.getY());
+
+    g.setColour(juce::Colours::grey.withAlpha(0.5f));
+    g.strokePath(pre_spectrum, juce::PathStrokeType(1.f), to_bounds);
+
+    g.setColour(juce::Colours::aqua.withAlpha(0.3f));
+    g.strokePath(post_peak_hold, juce::PathStrokeType(1.f), to_bounds);
+
+    g.setColour(juce::Colours::aqua);
+    g.strokePath(post_spectrum, juce::PathStrokeType(1.5f), to_bounds);
+}
@@ -0,0 +1,31 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Draws the pre and post EQ spectrum behind the response area.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpectrumAnalyser.h"
+
+class SpectrumAnalyserComponent : public juce::Component, private juce::Timer
+{
+public:
+    // Turns the analyser on for as long as this component exists
+    explicit SpectrumAnalyserComponent(SpectrumAnalyser&);
+    ~SpectrumAnalyserComponent() override;
+
+    void paint(juce::Graphics&) override;
+
+private:
+    void timerCallback() override;
+
+    SpectrumAnalyser& analyser;
+    juce::Path pre_spectrum, post_spectrum, post_peak_hold;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyserComponent)
+};
@@ -0,0 +1,187 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Per stage timing of processBlock, always compiled in and switched on
+    from the editor.
+
+  ==============================================================================
+*/
+
+#include "StageProfiler.h"
+#include <numeric>
+
+const char* StageProfiler::get_stage_name(int index) noexcept
+{
+    static const char* const names[] = { "Parameters", "Coefficients", "Low Cut", "Bands", "High Cut", "Whole Chain", "Analysis", "Total" };
+    return names[juce::jlimit(0, num_stages, index)];
+}
+
+StageProfiler::StageProfiler()
+{
+    design_thread->addTimeSliceClient(this);
+}
+
+StageProfiler::~StageProfiler()
+{
+    design_thread->removeTimeSliceClient(this);
+}
+
+void StageProfiler::set_enabled(bool should_be_enabled)
+{
+    if (should_be_enabled == enabled.load())
+        return;
+
+    if (should_be_enabled)
+    {
+        // The audio thread only touches the FIFO after it sees enabled, so it's safe to size it here
+        if (fifo_records.empty())
+            fifo_records.resize((size_t)fifo_size);
+
+        const juce::ScopedLock lock(history_lock);
+        if (history.empty())
+            history.resize((size_t)history_size);
+
+        history_end = history_count = 0;
+        calibration_cycles = read_cycle_counter();
+        calibration_ticks = juce::Time::getHighResolutionTicks();
+        num_dropped = 0;
+    }
+
+    enabled.store(should_be_enabled, std::memory_order_release);
+}
+
+void StageProfiler::end_block(int num_samples) noexcept
+{
+    if (!recording)
+        return;
+
+    current.num_samples = num_samples;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 + size2 == 0)
+    {
+        ++num_dropped;
+        return;
+    }
+
+    fifo_records[(size_t)(size1 > 0 ? start1 : start2)] = current;
+    fifo.finishedWrite(1);
+}
+
+int StageProfiler::useTimeSlice()
+{
+    auto num_ready = fifo.getNumReady();
+    if (num_ready == 0)
+        return 50;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(num_ready, start1, size1, start2, size2);
+    {
+        const juce::ScopedLock lock(history_lock);
+        auto append = [this](int start, int size)
+        {
+            for (int i = start; i < start + size; ++i)
+            {
+                history[(size_t)history_end] = fifo_records[(size_t)i];
+                history_end = (history_end + 1) % history_size;
+            }
+            history_count = juce::jmin(history_size, history_count + size);
+        };
+        append(start1, size1);
+        append(start2, size2);
+    }
+    fifo.finishedRead(size1 + size2);
+
+    return 50;
+}
+
+std::vector<StageProfiler::BlockRecord> StageProfiler::get_window(double window_seconds, double& cycles_per_microsecond) const
+{
+    std::vector<BlockRecord> records;
+    const juce::ScopedLock lock(history_lock);
+
+    auto elapsed_seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - calibration_ticks);
+    cycles_per_microsecond = elapsed_seconds > 0.0 ? (double)(read_cycle_counter() - calibration_cycles) / (elapsed_seconds * 1.0e6) : 0.0;
+    if (history_count == 0 || cycles_per_microsecond <= 0.0)
+        return records;
+
+    // Walk back from the newest block, so the window stays put while nothing is playing
+    auto newest = history[(size_t)((history_end + history_size - 1) % history_size)].start;
+    auto window_cycles = (juce::int64)(window_seconds * 1.0e6 * cycles_per_microsecond);
+    int count = 0;
+    while (count < history_count && newest - history[(size_t)((history_end + history_size - 1 - count) % history_size)].start <= window_cycles)
+        ++count;
+
+    records.reserve((size_t)count);
+    for (int i = count; i > 0; --i)
+        records.push_back(history[(size_t)((history_end + history_size - i) % history_size)]);
+    return records;
+}
+
+int StageProfiler::get_statistics(double window_seconds, std::array<StageStatistics, num_stages + 1>& statistics) const
+{
+    statistics = {};
+
+    double cycles_per_microsecond = 0.0;
+    auto records = get_window(window_seconds, cycles_per_microsecond);
+    if (records.empty())
+        return 0;
+
+    std::vector<double> times(records.size());
+    for (int index = 0; index <= num_stages; ++index)
+    {
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            auto& cycles = records[i].cycles;
+            auto total = index < num_stages ? cycles[(size_t)index] : std::accumulate(cycles.begin(), cycles.end(), (juce::int64)0);
+            times[i] = (double)total / cycles_per_microsecond;
+        }
+
+        auto& result = statistics[(size_t)index];
+        result.average_microseconds = std::accumulate(times.begin(), times.end(), 0.0) / (double)times.size();
+
+        auto p99 = times.begin() + (std::ptrdiff_t)(std::ceil(0.99 * (double)times.size()) - 1.0);
+        std::nth_element(times.begin(), p99, times.end());
+        result.p99_microseconds = *p99;
+        result.max_microseconds = *std::max_element(p99, times.end());
+    }
+
+    return (int)records.size();
+}
+
+bool StageProfiler::write_csv(const juce::File& file, double window_seconds) const
+{
+    double cycles_per_microsecond = 0.0;
+    auto records = get_window(window_seconds, cycles_per_microsecond);
+    if (records.empty())
+        return false;
+
+    file.deleteFile();
+    juce::FileOutputStream stream(file);
+    if (!stream.openedOk())
+        return false;
+
+    stream << "time_ms,num_samples";
+    for (int index = 0; index <= num_stages; ++index)
+        stream << "," << juce::String(get_stage_name(index)).toLowerCase().replaceCharacter(' ', '_') << "_us";
+    stream << "\n";
+
+    auto to_microseconds = [cycles_per_microsecond](juce::int64 cycles) { return juce::String((double)cycles / cycles_per_microsecond, 3); };
+    for (auto& record : records)
+    {
+        stream << juce::String((double)(record.start - records.front().start) / (cycles_per_microsecond * 1000.0), 3) << "," << record.num_samples;
+
+        juce::int64 total = 0;
+        for (auto cycles : record.cycles)
+        {
+            stream << "," << to_microseconds(cycles);
+            total += cycles;
+        }
+        stream << "," << to_microseconds(total) << "\n";
+    }
+
+    stream.flush();
+    return stream.getStatus().wasOk();
+}
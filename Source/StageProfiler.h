@@ -0,0 +1,150 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Per stage timing of processBlock, always compiled in and switched on
+    from the editor.
+
+    The audio thread reads the CPU's cycle counter at every stage boundary
+    and pushes one record per block into a lock-free FIFO. Nothing else
+    happens on the audio thread, and while the profiler is off every call
+    returns after one branch. The shared design thread drains the FIFO into
+    a history of the last blocks, which the editor reads for its overlay and
+    the CSV trace.
+
+    The biquad chain normally runs every section in one fused loop. While
+    the profiler records, it runs the low cut, the bands and the high cut
+    one after the other instead, so each gets its own time. Linear phase and
+    the state variable chain are timed whole. Cycles are converted to time
+    against juce::Time's high resolution clock, measured since the profiler
+    was switched on.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterDesigner.h"
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+class StageProfiler : private juce::TimeSliceClient
+{
+public:
+    enum class stage
+    {
+        parameters,
+        coefficients,
+        low_cut,
+        bands,
+        high_cut,
+        whole_chain,
+        analysis
+    };
+
+    static constexpr int num_stages = 7;
+
+    // The stage names, then "Total"
+    static const char* get_stage_name(int index) noexcept;
+
+    StageProfiler();
+    ~StageProfiler() override;
+
+    // Message thread. The buffers are allocated the first time it's switched on
+    void set_enabled(bool);
+    bool is_enabled() const noexcept { return enabled.load(); }
+
+    // Audio thread: whether this block is being timed
+    bool is_recording() const noexcept { return recording; }
+
+    // Audio thread
+    void begin_block() noexcept
+    {
+        recording = enabled.load(std::memory_order_acquire);
+        if (recording)
+        {
+            current = {};
+            current.start = last_mark = read_cycle_counter();
+        }
+    }
+
+    // Adds everything since the previous mark (or begin_block) to this stage
+    void mark(stage block_stage) noexcept
+    {
+        if (!recording)
+            return;
+
+        auto now = read_cycle_counter();
+        current.cycles[(size_t)block_stage] += now - last_mark;
+        last_mark = now;
+    }
+
+    void end_block(int num_samples) noexcept;
+
+    // Message thread: per stage and in total (the last entry), over the blocks that
+    // started within the last window_seconds of the newest one. Returns the number of blocks
+    struct StageStatistics
+    {
+        double average_microseconds{ 0.0 }, p99_microseconds{ 0.0 }, max_microseconds{ 0.0 };
+    };
+    int get_statistics(double window_seconds, std::array<StageStatistics, num_stages + 1>&) const;
+
+    // Message thread: one line per block of the same window, times in microseconds
+    bool write_csv(const juce::File&, double window_seconds) const;
+
+    // Blocks lost because the FIFO was full
+    int get_num_dropped() const noexcept { return num_dropped.load(); }
+
+    static juce::int64 read_cycle_counter() noexcept
+    {
+       #if JUCE_INTEL
+        return (juce::int64)__rdtsc();
+       #elif JUCE_ARM && JUCE_64BIT && (JUCE_GCC || JUCE_CLANG)
+        juce::int64 value;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+        return value;
+       #else
+        return juce::Time::getHighResolutionTicks();
+       #endif
+    }
+
+private:
+    struct BlockRecord
+    {
+        juce::int64 start{ 0 };
+        std::array<juce::int64, num_stages> cycles{};
+        int num_samples{ 0 };
+    };
+
+    static constexpr int fifo_size = 4096, history_size = 1 << 16;
+
+    int useTimeSlice() override;
+
+    // Copies the blocks in the window, oldest first, and works out the cycle rate
+    std::vector<BlockRecord> get_window(double window_seconds, double& cycles_per_microsecond) const;
+
+    std::atomic<bool> enabled{ false };
+    bool recording{ false };
+    BlockRecord current;
+    juce::int64 last_mark{ 0 };
+
+    juce::AbstractFifo fifo{ fifo_size };
+    std::vector<BlockRecord> fifo_records;
+    std::atomic<int> num_dropped{ 0 };
+
+    juce::CriticalSection history_lock;
+    std::vector<BlockRecord> history;
+    int history_end{ 0 }, history_count{ 0 };
+    juce::int64 calibration_cycles{ 0 }, calibration_ticks{ 0 };
+
+    juce::SharedResourcePointer<FilterDesigner::DesignThread> design_thread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StageProfiler)
+};
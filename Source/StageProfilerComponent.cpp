@@ -0,0 +1,67 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Shows the stage profiler's average, p99 and max per stage over the
+    response area while profiling is on.
+
+  ==============================================================================
+*/
+
+#include "StageProfilerComponent.h"
+
+StageProfilerComponent::StageProfilerComponent(StageProfiler& stage_profiler)
+    : profiler(stage_profiler)
+{
+    setInterceptsMouseClicks(false, false);
+    startTimerHz(4);
+}
+
+StageProfilerComponent::~StageProfilerComponent()
+{
+    stopTimer();
+}
+
+void StageProfilerComponent::timerCallback()
+{
+    auto was_showing = num_blocks > 0;
+    num_blocks = profiler.is_enabled() ? profiler.get_statistics(display_seconds, statistics) : 0;
+    if (was_showing || num_blocks > 0)
+        repaint();
+}
+
+void StageProfilerComponent::paint(juce::Graphics& g)
+{
+    if (num_blocks == 0)
+        return;
+
+    const auto row_height = 16;
+    auto area = getLocalBounds().reduced(6).removeFromLeft(300).removeFromTop(row_height * (StageProfiler::num_stages + 3));
+    g.setColour(juce::Colours::black.withAlpha(0.7f));
+    g.fillRect(area);
+
+    g.setColour(juce::Colours::aqua);
+    g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 12.f, juce::Font::plain));
+    area.reduce(4, 0);
+
+    auto draw_row = [&](const juce::String& name, const juce::String& average, const juce::String& p99, const juce::String& max)
+    {
+        auto row = area.removeFromTop(row_height);
+        auto column_width = row.getWidth() / 5;
+        g.drawText(name, row.removeFromLeft(column_width * 2), juce::Justification::centredLeft);
+        g.drawText(average, row.removeFromLeft(column_width), juce::Justification::centredRight);
+        g.drawText(p99, row.removeFromLeft(column_width), juce::Justification::centredRight);
+        g.drawText(max, row, juce::Justification::centredRight);
+    };
+
+    draw_row("Stage (us)", "avg", "p99", "max");
+    for (int index = 0; index <= StageProfiler::num_stages; ++index)
+    {
+        auto& stage = statistics[(size_t)index];
+        draw_row(StageProfiler::get_stage_name(index), juce::String(stage.average_microseconds, 1),
+                 juce::String(stage.p99_microseconds, 1), juce::String(stage.max_microseconds, 1));
+    }
+
+    auto dropped = profiler.get_num_dropped();
+    draw_row(juce::String(num_blocks) + " blocks", {}, {}, dropped > 0 ? juce::String(dropped) + " lost" : juce::String());
+}
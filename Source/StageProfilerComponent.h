@@ -0,0 +1,35 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    Shows the stage profiler's average, p99 and max per stage over the
+    response area while profiling is on.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "StageProfiler.h"
+
+class StageProfilerComponent : public juce::Component, private juce::Timer
+{
+public:
+    explicit StageProfilerComponent(StageProfiler&);
+    ~StageProfilerComponent() override;
+
+    void paint(juce::Graphics&) override;
+
+    // The overlay covers the last couple of seconds, a saved trace everything the history still holds
+    static constexpr double display_seconds = 2.0, trace_seconds = 30.0;
+
+private:
+    void timerCallback() override;
+
+    StageProfiler& profiler;
+    std::array<StageProfiler::StageStatistics, StageProfiler::num_stages + 1> statistics;
+    int num_blocks{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StageProfilerComponent)
+};
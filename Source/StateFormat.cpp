@@ -0,0 +1,66 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    The plugin state as a fixed layout binary blob.
+
+  ==============================================================================
+*/
+
+#include "StateFormat.h"
+
+bool is_binary_state(const void* data, int size_in_bytes) noexcept
+{
+    return size_in_bytes >= 8 && juce::ByteOrder::littleEndianInt(data) == (juce::uint32)binary_state_magic;
+}
+
+void write_binary_state(juce::OutputStream& stream, const juce::Array<juce::AudioProcessorParameter*>& parameters, const SnapshotBank& snapshot_bank, int current_program)
+{
+    stream.writeInt(binary_state_magic);
+    stream.writeInt(binary_state_version);
+
+    stream.writeInt(parameters.size());
+    for (auto* parameter : parameters)
+    {
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter);
+        stream.writeFloat(ranged != nullptr ? ranged->convertFrom0to1(ranged->getValue()) : parameter->getValue());
+    }
+
+    stream.writeInt(current_program);
+    snapshot_bank.write_binary(stream);
+}
+
+bool read_binary_state(juce::InputStream& stream, const juce::Array<juce::AudioProcessorParameter*>& parameters, SnapshotBank& snapshot_bank, int& current_program)
+{
+    if (stream.readInt() != binary_state_magic || stream.readInt() > binary_state_version)
+        return false;
+
+    // Everything is read before anything is set, a truncated blob changes nothing
+    auto num_values = stream.readInt();
+    if (num_values < 0 || stream.getNumBytesRemaining() < (juce::int64)num_values * 4 + 4)
+        return false;
+
+    std::vector<float> values((size_t)num_values);
+    for (auto& value : values)
+        value = stream.readFloat();
+    auto program = stream.readInt();
+
+    if (!snapshot_bank.read_binary(stream))
+        return false;
+
+    for (int i = 0; i < juce::jmin(num_values, parameters.size()); ++i)
+    {
+        auto value = values[(size_t)i];
+        if (!std::isfinite(value))
+            continue;
+
+        auto* parameter = parameters.getUnchecked(i);
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter);
+        auto normalised = ranged != nullptr ? ranged->convertTo0to1(value) : juce::jlimit(0.f, 1.f, value);
+        if (normalised != parameter->getValue())
+            parameter->setValueNotifyingHost(normalised);
+    }
+
+    current_program = juce::jlimit(0, SnapshotBank::num_snapshots - 1, program);
+    return true;
+}
@@ -0,0 +1,38 @@
+//Copyright2023 Vishal Ahirwar. All rights reserved.
+/*
+  ==============================================================================
+
+    The plugin state as a fixed layout binary blob.
+
+    Version 1, every value little endian:
+        int32   magic "SEQS"
+        int32   version
+        int32   number of parameters, then each one's value in real units
+                (float), in the order of the parameter layout
+        int32   current program
+        the snapshot bank, see SnapshotBank::write_binary
+
+    Parameters and snapshot values are only ever added at the end, and
+    both lists carry their length, so a newer build reads an older blob
+    (the values it doesn't find keep their defaults) and an older build
+    skips what it doesn't know. The version only changes when that no
+    longer holds. Blobs without the magic are taken for the ValueTree
+    state every build before this format wrote.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SnapshotBank.h"
+
+constexpr juce::int32 binary_state_magic = 0x53514553, binary_state_version = 1;
+
+bool is_binary_state(const void* data, int size_in_bytes) noexcept;
+
+void write_binary_state(juce::OutputStream&, const juce::Array<juce::AudioProcessorParameter*>&, const SnapshotBank&, int current_program);
+
+// Sets only the parameters whose value changed. Returns false, without touching
+// anything, for a blob that's too short or from a newer version
+bool read_binary_state(juce::InputStream&, const juce::Array<juce::AudioProcessorParameter*>&, SnapshotBank&, int& current_program);